@@ -97,13 +97,17 @@ OpenFile::Write(char *into, int numBytes)
 //	sector at a time.  Thus:
 //
 //	For ReadAt:
-//	   We read in all of the full or partial sectors that are part of the
-//	   request, but we only copy the part we are interested in.
+//	   We read in the partial sectors at either end of the request into
+//	   a sector buffer, and only copy the part we are interested in.
+//	   The full sectors in between are read straight into "into".
 //	For WriteAt:
 //	   We must first read in any sectors that will be partially written,
 //	   so that we don't overwrite the unmodified portion.  We then copy
-//	   in the data that will be modified, and write back all the full
-//	   or partial sectors that are part of the request.
+//	   in the data that will be modified, and write them back.  The full
+//	   sectors in between are written straight from "from".
+//
+//	Either way there is no buffer as large as the request, and runs of
+//	sectors that are contiguous on disk take one disk request.
 //
 //	"into" -- the buffer to contain the data to be read from disk 
 //	"from" -- the buffer containing the data to be written to disk 
@@ -116,8 +120,8 @@ int
 OpenFile::ReadAt(char *into, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    char *buf;
+    int firstSector, lastSector, first, last, end;
+    char buf[SectorSize];
 
     if ((numBytes <= 0) || (position >= fileLength))
     	return 0; 				// check request
@@ -125,19 +129,27 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 	numBytes = fileLength - position;
     DEBUG(dbgFile, "Reading " << numBytes << " bytes at " << position << " from file of length " << fileLength);
 
-    firstSector = divRoundDown(position, SectorSize);
-    lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
-
-    // read in all the full and partial sectors that we need
-    buf = new char[numSectors * SectorSize];
-    for (i = firstSector; i <= lastSector; i++)	
-        kernel->synchDisk->ReadSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-
-    // copy the part we want
-    bcopy(&buf[position - (firstSector * SectorSize)], into, numBytes);
-    delete [] buf;
+    end = position + numBytes;
+    first = firstSector = divRoundDown(position, SectorSize);
+    last = lastSector = divRoundDown(end - 1, SectorSize);
+
+    // read in the partial sectors at either end, and copy the part
+    // we want
+    if (position != firstSector * SectorSize) {
+        kernel->synchDisk->ReadSector(hdr->ByteToSector(position), buf);
+        bcopy(&buf[position - firstSector * SectorSize], into,
+		min(numBytes, (firstSector + 1) * SectorSize - position));
+        first++;
+    }
+    if (first <= last && end != (lastSector + 1) * SectorSize) {
+        kernel->synchDisk->ReadSector(hdr->ByteToSector(end - 1), buf);
+        bcopy(buf, &into[lastSector * SectorSize - position],
+		end - lastSector * SectorSize);
+        last--;
+    }
+
+    // and the full sectors in between straight into "into"
+    TransferSectors(first, last, &into[first * SectorSize - position], FALSE);
     return numBytes;
 }
 
@@ -145,9 +157,8 @@ int
 OpenFile::WriteAt(char *from, int numBytes, int position)
 {
     int fileLength = hdr->FileLength();
-    int i, firstSector, lastSector, numSectors;
-    bool firstAligned, lastAligned;
-    char *buf;
+    int firstSector, lastSector, first, last, end;
+    char buf[SectorSize];
 
     if ((numBytes <= 0) || (position >= fileLength))
 	return 0;				// check request
@@ -155,31 +166,60 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
 	numBytes = fileLength - position;
     DEBUG(dbgFile, "Writing " << numBytes << " bytes at " << position << " from file of length " << fileLength);
 
-    firstSector = divRoundDown(position, SectorSize);
-    lastSector = divRoundDown(position + numBytes - 1, SectorSize);
-    numSectors = 1 + lastSector - firstSector;
-
-    buf = new char[numSectors * SectorSize];
-
-    firstAligned = (position == (firstSector * SectorSize));
-    lastAligned = ((position + numBytes) == ((lastSector + 1) * SectorSize));
-
-// read in first and last sector, if they are to be partially modified
-    if (!firstAligned)
-        ReadAt(buf, SectorSize, firstSector * SectorSize);	
-    if (!lastAligned && ((firstSector != lastSector) || firstAligned))
-        ReadAt(&buf[(lastSector - firstSector) * SectorSize], 
-				SectorSize, lastSector * SectorSize);	
+    end = position + numBytes;
+    first = firstSector = divRoundDown(position, SectorSize);
+    last = lastSector = divRoundDown(end - 1, SectorSize);
+
+// read in first and last sector, if they are to be partially modified,
+// copy in the bytes we want to change, and write them back
+    if (position != firstSector * SectorSize) {
+        int sector = hdr->ByteToSector(position);
+
+        kernel->synchDisk->ReadSector(sector, buf);
+        bcopy(from, &buf[position - firstSector * SectorSize],
+		min(numBytes, (firstSector + 1) * SectorSize - position));
+        kernel->synchDisk->WriteSector(sector, buf);
+        first++;
+    }
+    if (first <= last && end != (lastSector + 1) * SectorSize) {
+        int sector = hdr->ByteToSector(end - 1);
+
+        kernel->synchDisk->ReadSector(sector, buf);
+        bcopy(&from[lastSector * SectorSize - position], buf,
+		end - lastSector * SectorSize);
+        kernel->synchDisk->WriteSector(sector, buf);
+        last--;
+    }
+
+// write the full sectors in between straight from "from"
+    TransferSectors(first, last, &from[first * SectorSize - position], TRUE);
+    return numBytes;
+}
 
-// copy in the bytes we want to change 
-    bcopy(from, &buf[position - (firstSector * SectorSize)], numBytes);
+//----------------------------------------------------------------------
+// OpenFile::TransferSectors
+// 	Read (or if "writing", write) sectors "first" through "last" of
+//	the file, from/to "data".  Sectors of the file that are next to
+//	each other on disk are transferred with a single request.
+//----------------------------------------------------------------------
 
-// write modified sectors back
-    for (i = firstSector; i <= lastSector; i++)	
-        kernel->synchDisk->WriteSector(hdr->ByteToSector(i * SectorSize), 
-					&buf[(i - firstSector) * SectorSize]);
-    delete [] buf;
-    return numBytes;
+void
+OpenFile::TransferSectors(int first, int last, char *data, bool writing)
+{
+    while (first <= last) {
+        int sector = hdr->ByteToSector(first * SectorSize);
+        int count = 1;
+
+        while (first + count <= last &&
+		hdr->ByteToSector((first + count) * SectorSize) == sector + count)
+	    count++;
+        if (writing)
+	    kernel->synchDisk->WriteSectors(sector, count, data);
+        else
+	    kernel->synchDisk->ReadSectors(sector, count, data);
+        data += count * SectorSize;
+        first += count;
+    }
 }
 
 //----------------------------------------------------------------------
@@ -58,6 +58,7 @@ class OpenFile {
 		return numWritten;
 		}
 
+    void Seek(int position) { currentOffset = position; }
     int Length() { Lseek(file, 0, 2); return Tell(file); }
 
   private:
@@ -94,6 +95,10 @@ class OpenFile {
 					// end of file, tell, lseek back
 
   private:
+    void TransferSectors(int first, int last, char *data, bool writing);
+					// Read/write whole sectors of the
+					// file, straight from/to "data"
+
     FileHeader *hdr;			// Header for this file
     int seekPosition;			// Current position within the file
 };
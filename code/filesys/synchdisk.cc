@@ -16,6 +16,7 @@
 
 #include "copyright.h"
 #include "synchdisk.h"
+#include "main.h"
 
 
 //----------------------------------------------------------------------
@@ -29,6 +30,8 @@ SynchDisk::SynchDisk()
 {
     semaphore = new Semaphore("synch disk", 0);
     lock = new Lock("synch disk lock");
+    busy = writingBehind = behindWaiter = FALSE;
+    behindDone = new Semaphore("write behind", 0);
     disk = new Disk(this);
 }
 
@@ -43,6 +46,7 @@ SynchDisk::~SynchDisk()
     delete disk;
     delete lock;
     delete semaphore;
+    delete behindDone;
 }
 
 //----------------------------------------------------------------------
@@ -58,8 +62,10 @@ void
 SynchDisk::ReadSector(int sectorNumber, char* data)
 {
     lock->Acquire();			// only one disk I/O at a time
+    StartRequest();
     disk->ReadRequest(sectorNumber, data);
     semaphore->P();			// wait for interrupt
+    busy = FALSE;
     lock->Release();
 }
 
@@ -76,19 +82,105 @@ void
 SynchDisk::WriteSector(int sectorNumber, char* data)
 {
     lock->Acquire();			// only one disk I/O at a time
+    StartRequest();
     disk->WriteRequest(sectorNumber, data);
     semaphore->P();			// wait for interrupt
+    busy = FALSE;
     lock->Release();
 }
 
+//----------------------------------------------------------------------
+// SynchDisk::ReadSectors/WriteSectors
+// 	Read or write "count" consecutive sectors, starting at
+//	"firstSector", with one disk request.  Return only after the
+//	transfer is done.
+//
+//	"data" -- "count" * SectorSize bytes
+//----------------------------------------------------------------------
+
+void
+SynchDisk::ReadSectors(int firstSector, int count, char* data)
+{
+    lock->Acquire();			// only one disk I/O at a time
+    StartRequest();
+    disk->ReadRequest(firstSector, count, data);
+    semaphore->P();			// wait for interrupt
+    busy = FALSE;
+    lock->Release();
+}
+
+void
+SynchDisk::WriteSectors(int firstSector, int count, char* data)
+{
+    lock->Acquire();			// only one disk I/O at a time
+    StartRequest();
+    disk->WriteRequest(firstSector, count, data);
+    semaphore->P();			// wait for interrupt
+    busy = FALSE;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::StartRequest
+// 	Called with "lock" held, before sending a request to the disk.
+//	If a write behind is still in progress, wait for it to finish,
+//	since the disk only does one request at a time.
+//----------------------------------------------------------------------
+
+void
+SynchDisk::StartRequest()
+{
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+
+    busy = TRUE;			// no new write behind from now on
+    if (writingBehind) {
+	behindWaiter = TRUE;
+	behindDone->P();
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// SynchDisk::WriteBehind
+// 	Start writing "count" sectors from "data", starting at
+//	"firstSector", if the disk isn't being used, and return at once.
+//	The data is copied out when the request starts, so "data" can be
+//	reused right away.
+//
+//	This doesn't block, so it can be called when no thread can run
+//	(Interrupt::Idle) to get disk writes done ahead of time.
+//	Returns FALSE, writing nothing, if the disk is busy.
+//----------------------------------------------------------------------
+
+bool
+SynchDisk::WriteBehind(int firstSector, int count, char* data)
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOff);
+    if (busy || writingBehind) {
+	return FALSE;
+    }
+    writingBehind = TRUE;
+    disk->WriteRequest(firstSector, count, data);
+    return TRUE;
+}
+
 //----------------------------------------------------------------------
 // SynchDisk::CallBack
 // 	Disk interrupt handler.  Wake up any thread waiting for the disk
-//	request to finish.
+//	request to finish.  Nobody waits for a write behind, unless a
+//	new request is waiting to start.
 //----------------------------------------------------------------------
 
 void
 SynchDisk::CallBack()
 { 
+    if (writingBehind) {
+	writingBehind = FALSE;
+	if (behindWaiter) {
+	    behindWaiter = FALSE;
+	    behindDone->V();
+	}
+	return;
+    }
     semaphore->V();
 }
@@ -39,7 +39,19 @@ class SynchDisk : public CallBackObj {
     					// Disk::ReadRequest/WriteRequest and
 					// then wait until the request is done.
     void WriteSector(int sectorNumber, char* data);
+
+    void ReadSectors(int firstSector, int count, char* data);
+    void WriteSectors(int firstSector, int count, char* data);
+					// Same, for a run of "count"
+					// consecutive sectors, transferred
+					// by a single disk request
     
+    bool WriteBehind(int firstSector, int count, char* data);
+					// Start writing a run of sectors,
+					// and return without waiting; FALSE
+					// (and nothing written) if the disk
+					// is in use.  Meant for idle time.
+
     void CallBack();			// Called by the disk device interrupt
 					// handler, to signal that the
 					// current disk operation is complete.
@@ -50,6 +62,12 @@ class SynchDisk : public CallBackObj {
 					// with the interrupt handler
     Lock *lock;		  		// Only one read/write request
 					// can be sent to the disk at a time
+    bool busy;				// is a thread holding "lock"?
+    bool writingBehind;			// is a WriteBehind in progress?
+    bool behindWaiter;			// is a thread waiting for it?
+    Semaphore *behindDone;		// ... on this
+
+    void StartRequest();		// Wait out any write behind
 };
 
 #endif // SYNCHDISK_H
@@ -119,6 +119,24 @@ Bitmap::FindAndSet()
     return -1;
 }
 
+//----------------------------------------------------------------------
+// Bitmap::FindLast
+// 	Return the number of the highest bit which is set, or -1 if
+//	none is.  Skips a word of clear bits at a time, so this is fast
+//	for a small bitmap whatever is set.
+//----------------------------------------------------------------------
+
+int
+Bitmap::FindLast() const
+{
+    for (int i = numWords - 1; i >= 0; i--) {
+	if (map[i] != 0) {
+	    return i * BitsInWord + BitsInWord - 1 - __builtin_clz(map[i]);
+	}
+    }
+    return -1;
+}
+
 //----------------------------------------------------------------------
 // Bitmap::NumClear
 // 	Return the number of clear bits in the bitmap.
@@ -43,6 +43,8 @@ class Bitmap {
 				// effect, set the bit. 
 				// If no bits are clear, return -1.
     int NumClear() const;	// Return the number of clear bits
+    int FindLast() const;	// Return the # of the highest set bit,
+				// -1 if none is set
 
     void Print() const;		// Print contents of bitmap
     void SelfTest();		// Test whether bitmap is working
@@ -149,6 +149,22 @@ UDelay(unsigned int useconds)
 
 }
 
+//----------------------------------------------------------------------
+// HostMicroseconds
+// 	Return the time of day on the host, in microseconds.  Only
+//	differences mean anything: this measures how long the simulator
+//	itself takes to do something, not simulated time.
+//----------------------------------------------------------------------
+
+double
+HostMicroseconds()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec * 1000000.0 + tv.tv_usec;
+}
+
 //----------------------------------------------------------------------
 // Abort
 // 	Quit and drop core.
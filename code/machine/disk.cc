@@ -150,6 +150,78 @@ Disk::WriteRequest(int sectorNumber, char* data)
     kernel->interrupt->Schedule(this, ticks, DiskInt);
 }
 
+//----------------------------------------------------------------------
+// Disk::ReadRequest/WriteRequest
+// 	Simulate a request to read/write "count" consecutive disk
+//	sectors, starting at "firstSector", as one request.  The head
+//	only has to get to the first sector; the rest stream past it
+//	one per RotationTime (plus a track-to-track seek, when the run
+//	crosses into the next track), so this is much faster than
+//	"count" separate requests.
+//
+//	"data" -- the bytes to be written, the buffer to hold the incoming
+//	bytes; "count" * SectorSize bytes long
+//----------------------------------------------------------------------
+
+void
+Disk::ReadRequest(int firstSector, int count, char* data)
+{
+    int ticks = ComputeLatency(firstSector, FALSE) + RunTime(firstSector, count);
+
+    ASSERT(!active);				// only one request at a time
+    ASSERT((firstSector >= 0) && (count > 0) &&
+		(firstSector + count <= NumSectors));
+
+    DEBUG(dbgDisk, "Reading " << count << " sectors from " << firstSector);
+    Lseek(fileno, SectorSize * firstSector + MagicSize, 0);
+    Read(fileno, data, SectorSize * count);
+    if (debug->IsEnabled('d'))
+	for (int i = 0; i < count; i++)
+	    PrintSector(FALSE, firstSector + i, data + i * SectorSize);
+
+    active = TRUE;
+    UpdateLast(firstSector + count - 1);
+    kernel->stats->numDiskReads++;
+    kernel->interrupt->Schedule(this, ticks, DiskInt);
+}
+
+void
+Disk::WriteRequest(int firstSector, int count, char* data)
+{
+    int ticks = ComputeLatency(firstSector, TRUE) + RunTime(firstSector, count);
+
+    ASSERT(!active);
+    ASSERT((firstSector >= 0) && (count > 0) &&
+		(firstSector + count <= NumSectors));
+
+    DEBUG(dbgDisk, "Writing " << count << " sectors to " << firstSector);
+    Lseek(fileno, SectorSize * firstSector + MagicSize, 0);
+    WriteFile(fileno, data, SectorSize * count);
+    if (debug->IsEnabled('d'))
+	for (int i = 0; i < count; i++)
+	    PrintSector(TRUE, firstSector + i, data + i * SectorSize);
+
+    active = TRUE;
+    UpdateLast(firstSector + count - 1);
+    kernel->stats->numDiskWrites++;
+    kernel->interrupt->Schedule(this, ticks, DiskInt);
+}
+
+//----------------------------------------------------------------------
+// Disk::RunTime()
+// 	Return how much longer a request for "count" consecutive sectors
+//	takes than one for just "firstSector".
+//----------------------------------------------------------------------
+
+int
+Disk::RunTime(int firstSector, int count)
+{
+    int lastSector = firstSector + count - 1;
+    int tracks = lastSector / SectorsPerTrack - firstSector / SectorsPerTrack;
+
+    return (count - 1) * RotationTime + tracks * SeekTime;
+}
+
 //----------------------------------------------------------------------
 // Disk::CallBack()
 // 	Called by the machine simulation when the disk interrupt occurs.
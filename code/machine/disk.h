@@ -66,6 +66,10 @@ class Disk : public CallBackObj {
     					// the disk and return immediately.
     					// Only one request allowed at a time!
     void WriteRequest(int sectorNumber, char* data);
+    void ReadRequest(int firstSector, int count, char* data);
+    void WriteRequest(int firstSector, int count, char* data);
+					// Read/write "count" consecutive
+					// sectors as a single request
 
     void CallBack();			// Invoked when disk request 
 					// finishes. In turn calls, callWhenDone.
@@ -86,6 +90,8 @@ class Disk : public CallBackObj {
 
     int TimeToSeek(int newSector, int *rotate); // time to get to the new track
     int ModuloDiff(int to, int from);        // # sectors between to and from
+    int RunTime(int firstSector, int count);	// extra time to transfer
+					// the sectors after the first
     void UpdateLast(int newSector);
 };
 
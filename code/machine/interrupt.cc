@@ -23,6 +23,11 @@
 #include "copyright.h"
 #include "interrupt.h"
 #include "main.h"
+#include "frametable.h"
+#include "invertedtable.h"
+#include "syscalltable.h"
+#include "stackpool.h"
+#include "uthread.h"
 
 // String definitions for debugging messages
 
@@ -75,6 +80,7 @@ Interrupt::Interrupt()
     pending = new SortedList<PendingInterrupt *>(PendingCompare);
     inHandler = FALSE;
     yieldOnReturn = FALSE;
+    preemptThread = NULL;
     status = SystemMode;
 }
 
@@ -149,6 +155,7 @@ Interrupt::OneTick()
 {
     MachineStatus oldStatus = status;
     Statistics *stats = kernel->stats;
+    bool preempt;
 
 // advance simulated time
     if (status == SystemMode) {
@@ -167,39 +174,27 @@ Interrupt::OneTick()
     CheckIfDue(FALSE);		// check for pending interrupts
     ChangeLevel(IntOff, IntOn);	// re-enable interrupts
 
+    preempt = (preemptThread == kernel->currentThread);
+    preemptThread = NULL;	// a thread that has since blocked
+				// needn't yield any more
+
 	/* MP3 if currentThread is RR and time to switch */
-    if (yieldOnReturn && kernel->currentThread->getPriority() <= 49)
+    if (preempt || (yieldOnReturn
+		&& kernel->scheduler->Policy()->TimeSliced(kernel->currentThread)))
 	{	// if the timer device handler asked
     				// for a context switch, ok to do it now
 		yieldOnReturn = FALSE;
 	 	status = SystemMode;		// yield is a kernel routine
 		kernel->currentThread->Yield();
 		status = oldStatus;
+		AddrSpace *space = kernel->currentThread->space;
+		if (status == UserMode && space != NULL && space->MultiThreaded())
+			space->Threads()->CheckExiting();	// its program is
+								// exiting
     }
 
 	/* MP3 Check Aging */
-	ListIterator<Thread *> *iterL1 = new ListIterator<Thread *>(kernel->scheduler->L1Queue);
-	ListIterator<Thread *> *iterL2 = new ListIterator<Thread *>(kernel->scheduler->L2Queue);
-	ListIterator<Thread *> *iterL3 = new ListIterator<Thread *>(kernel->scheduler->readyList);
-
-	for (; !iterL1->IsDone(); iterL1->Next())
-	{
-		Thread* t = iterL1->Item();
-		kernel->scheduler->L1Queue->Remove(t);
-		bool ag = kernel->scheduler->CheckAging(t);
-		if(!ag) kernel->scheduler->L1Queue->Insert(t);
-  	}
-
-	for (; !iterL2->IsDone(); iterL2->Next())
-	{
-		Thread* t = iterL2->Item();
-		kernel->scheduler->L2Queue->Remove(t);
-		bool ag = kernel->scheduler->CheckAging(t);
-		if(!ag) kernel->scheduler->L2Queue->Insert(t);
-	}
-
-	for (; !iterL3->IsDone(); iterL3->Next())
-		kernel->scheduler->CheckAging(iterL3->Item());
+	kernel->scheduler->Policy()->Tick();
 }
 
 //----------------------------------------------------------------------
@@ -220,6 +215,26 @@ Interrupt::YieldOnReturn()
     yieldOnReturn = TRUE;
 }
 
+//----------------------------------------------------------------------
+// Interrupt::PreemptOnReturn
+// 	Called, with interrupts disabled, when a thread was made ready
+//	which the running thread must yield to (see Scheduler::ReadyToRun).
+//	The switch happens in OneTick: when the interrupt handler returns,
+//	or else when interrupts are re-enabled.  Unlike YieldOnReturn, it
+//	doesn't wait for the end of the running thread's time slice.
+//
+//	Switching right away would be wrong even outside a handler: the
+//	caller, such as Semaphore::V, may not be done updating what the
+//	woken thread is about to check.
+//----------------------------------------------------------------------
+
+void
+Interrupt::PreemptOnReturn()
+{
+    ASSERT(level == IntOff);
+    preemptThread = kernel->currentThread;
+}
+
 //----------------------------------------------------------------------
 // Interrupt::Idle
 // 	Routine called when there is nothing in the ready queue.
@@ -236,6 +251,13 @@ Interrupt::Idle()
 {
     DEBUG(dbgInt, "Machine idling; checking for interrupts.");
     status = IdleMode;
+    if (!pending->IsEmpty()) {	// waiting for a device; meanwhile,
+				// get memory ready for later use
+	kernel->frameTable->ZeroFreeFrames();
+	if (kernel->swapSpace != NULL) {
+	    AddrSpace::PreClean();
+	}
+    }
     if (CheckIfDue(TRUE)) {	// check for any pending interrupts
 	status = SystemMode;
 	return;			// return in case there's now
@@ -263,6 +285,18 @@ Interrupt::Halt()
     cout << "Machine halting!\n\n";
     cout << "This is halt\n";
     kernel->stats->Print();
+    if (debug->IsEnabled(dbgAddr)) {
+	kernel->frameTable->PrintStats();
+    }
+    if (kernel->invertedTable != NULL) {
+	kernel->invertedTable->PrintStats();
+    }
+    if (debug->IsEnabled(dbgSys)) {
+	kernel->syscallTable->PrintStats();
+    }
+    if (debug->IsEnabled(dbgThread)) {
+	kernel->stackPool->PrintStats();
+    }
     delete kernel;	// Never returns.
 }
 
@@ -411,3 +445,8 @@ int Interrupt::Close(int id)
 {
 	return kernel->Close(id);
 }
+
+int Interrupt::Seek(int position, int id)
+{
+	return kernel->Seek(position, id);
+}
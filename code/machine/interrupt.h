@@ -37,6 +37,8 @@
 #include "list.h"
 #include "callback.h"
 
+class Thread;
+
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
 
@@ -98,6 +100,10 @@ class Interrupt {
 
     void YieldOnReturn();	// cause a context switch on return
 				// from an interrupt handler
+    void PreemptOnReturn();	// ... even if the running thread's
+				// time slice is not over; outside
+				// a handler, once interrupts are
+				// re-enabled
 
     MachineStatus getStatus() { return status; }
     void setStatus(MachineStatus st) { status = st; }
@@ -124,6 +130,7 @@ class Interrupt {
 	int Write(char* buffer , int size , int id);
 	int Read(char* buffer , int size , int id);
 	int Close(int id);
+	int Seek(int position, int id);
 
   private:
     IntStatus level;		// are interrupts enabled or disabled?
@@ -136,6 +143,9 @@ class Interrupt {
                                   //If so, you cannoot do another one
     bool yieldOnReturn; 	// TRUE if we are to context switch
 				// on return from the interrupt handler
+    Thread *preemptThread;	// ... or to switch out this thread,
+				// whatever the scheduling policy
+				// says of the time slice
     MachineStatus status;	// idle, kernel mode, user mode
 
     // these functions are internal to the interrupt simulation code
@@ -0,0 +1,252 @@
+// invertedtable.cc
+//	Routines to manage the hashed inverted page table.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "invertedtable.h"
+
+//----------------------------------------------------------------------
+// InvertedPageTable::InvertedPageTable
+// 	Initialize an inverted page table for "numFrames" physical
+//	frames, with every frame unmapped.
+//----------------------------------------------------------------------
+
+InvertedPageTable::InvertedPageTable(int nFrames)
+{
+    numFrames = nFrames;
+    for (bucketBits = 1; (1 << bucketBits) < numFrames; bucketBits++)
+	;
+    numBuckets = 1 << bucketBits;
+
+    entries = new TranslationEntry[numFrames];
+    owner = new int[numFrames];
+    next = new int[numFrames];
+    bucket = new int[numBuckets];
+    for (int i = 0; i < numFrames; i++) {
+	entries[i].virtualPage = -1;
+	entries[i].physicalPage = i;	// never changes
+	entries[i].valid = FALSE;
+	entries[i].readOnly = FALSE;
+	entries[i].use = FALSE;
+	entries[i].dirty = FALSE;
+	entries[i].large = FALSE;	// large pages aren't supported
+	owner[i] = -1;
+	next[i] = -1;
+    }
+    for (int i = 0; i < numBuckets; i++) {
+	bucket[i] = -1;
+    }
+    numMapped = 0;
+
+    numLookups = numMisses = numProbes = longestProbe = 0;
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::~InvertedPageTable
+// 	De-allocate the table.
+//----------------------------------------------------------------------
+
+InvertedPageTable::~InvertedPageTable()
+{
+    delete [] entries;
+    delete [] owner;
+    delete [] next;
+    delete [] bucket;
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::Hash
+// 	Multiplicative hash of (space, vpn).  Consecutive pages of one
+//	address space, and the same page of consecutive address spaces,
+//	land in different buckets.
+//----------------------------------------------------------------------
+
+int
+InvertedPageTable::Hash(int space, unsigned int vpn) const
+{
+    unsigned int key = vpn ^ ((unsigned int) space * 0x85ebca6bu);
+
+    return (key * 0x9e3779b1u) >> (32 - bucketBits);
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::Lookup
+// 	Find the frame holding page "vpn" of address space "space", by
+//	walking the hash chain for the pair.  Returns its entry, or NULL
+//	if the page is not in memory.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+InvertedPageTable::Lookup(int space, unsigned int vpn)
+{
+    int probes = 0;
+
+    numLookups++;
+    for (int i = bucket[Hash(space, vpn)]; i != -1; i = next[i]) {
+	probes++;
+	if (owner[i] == space && entries[i].virtualPage == (int) vpn) {
+	    numProbes += probes;
+	    longestProbe = max(longestProbe, probes);
+	    return &entries[i];
+	}
+    }
+    numProbes += probes;
+    longestProbe = max(longestProbe, probes);
+    numMisses++;
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::Map
+// 	Record that page "vpn" of address space "space" lives in frame
+//	"frame", and link the frame into its hash chain.  New entries
+//	go at the head of the chain.
+//
+//	Returns the new entry, so the caller can adjust its bits.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+InvertedPageTable::Map(int space, unsigned int vpn, int frame, bool readOnly)
+{
+    int b = Hash(space, vpn);
+    TranslationEntry *entry = &entries[frame];
+
+    ASSERT(frame >= 0 && frame < numFrames);
+    ASSERT(owner[frame] == -1);		// one page per frame
+
+    owner[frame] = space;
+    entry->virtualPage = vpn;
+    entry->valid = TRUE;
+    entry->readOnly = readOnly;
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+
+    next[frame] = bucket[b];
+    bucket[b] = frame;
+    numMapped++;
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::Unmap
+// 	Remove the mapping of frame "frame", unlinking it from its
+//	hash chain.
+//----------------------------------------------------------------------
+
+void
+InvertedPageTable::Unmap(int frame)
+{
+    int *link;
+
+    ASSERT(owner[frame] != -1);
+    link = &bucket[Hash(owner[frame], entries[frame].virtualPage)];
+    while (*link != frame) {
+	ASSERT(*link != -1);		// must be on its own chain
+	link = &next[*link];
+    }
+    *link = next[frame];
+
+    owner[frame] = -1;
+    next[frame] = -1;
+    entries[frame].valid = FALSE;
+    entries[frame].virtualPage = -1;
+    numMapped--;
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::UnmapSpace
+// 	Remove every mapping belonging to address space "space", when
+//	it is destroyed.  The frames it used are stored into "frames",
+//	so the caller can free them.  Returns the number of frames.
+//----------------------------------------------------------------------
+
+int
+InvertedPageTable::UnmapSpace(int space, int *frames)
+{
+    int n = 0;
+
+    for (int i = 0; i < numFrames; i++) {
+	if (owner[i] == space) {
+	    Unmap(i);
+	    frames[n++] = i;
+	}
+    }
+    return n;
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::PrintStats
+// 	Print the current distribution of hash chain lengths, and how
+//	many entries Lookup had to compare on average.
+//----------------------------------------------------------------------
+
+void
+InvertedPageTable::PrintStats() const
+{
+    int used = 0, longest = 0;
+
+    for (int b = 0; b < numBuckets; b++) {
+	int length = 0;
+
+	for (int i = bucket[b]; i != -1; i = next[i]) {
+	    length++;
+	}
+	if (length > 0) {
+	    used++;
+	    longest = max(longest, length);
+	}
+    }
+    cout << "Inverted page table: " << numMapped << " of " << numFrames;
+    cout << " frames mapped, " << used << " of " << numBuckets;
+    cout << " buckets used\n";
+    cout << "Inverted page table: longest chain " << longest;
+    cout << ", average chain " << (used == 0 ? 0.0 : (double) numMapped / used);
+    cout << "\n";
+    cout << "Inverted page table: lookups " << numLookups;
+    cout << ", misses " << numMisses << ", average probes ";
+    cout << (numLookups == 0 ? 0.0 : (double) numProbes / numLookups);
+    cout << ", longest probe " << longestProbe << "\n";
+}
+
+//----------------------------------------------------------------------
+// InvertedPageTable::SelfTest
+// 	Test whether this module is working.  Must be run on an empty
+//	table with at least 16 frames.
+//----------------------------------------------------------------------
+
+void
+InvertedPageTable::SelfTest()
+{
+    int frames[16];
+
+    ASSERT(numFrames >= 16 && numMapped == 0);
+
+    // the same virtual pages in two address spaces
+    for (int i = 0; i < 8; i++) {
+	Map(1, i, i, FALSE);
+	Map(2, i, 8 + i, i == 0);
+    }
+    for (int i = 0; i < 8; i++) {
+	ASSERT(Lookup(1, i)->physicalPage == i);
+	ASSERT(Lookup(2, i)->physicalPage == 8 + i);
+    }
+    ASSERT(Lookup(2, 0)->readOnly && !Lookup(1, 0)->readOnly);
+    ASSERT(Lookup(1, 8) == NULL && Lookup(3, 0) == NULL);
+
+    // removing an entry must not break the rest of its chain
+    Unmap(3);
+    ASSERT(Lookup(1, 3) == NULL && Owner(3) == -1);
+    for (int i = 0; i < 8; i++) {
+	ASSERT(i == 3 || Lookup(1, i)->physicalPage == i);
+    }
+
+    ASSERT(UnmapSpace(2, frames) == 8);
+    ASSERT(frames[0] == 8 && frames[7] == 15);
+    ASSERT(Lookup(2, 0) == NULL && Lookup(1, 0) != NULL);
+    ASSERT(UnmapSpace(1, frames) == 7);
+    ASSERT(numMapped == 0);
+}
@@ -0,0 +1,81 @@
+// invertedtable.h
+//	Data structures for a hashed inverted page table: one global
+//	table, with one entry per physical page frame, shared by all
+//	address spaces.
+//
+//	An entry records which address space ("space") and which virtual
+//	page of it live in the frame.  To find the frame holding a given
+//	(space, virtual page) pair, the pair is hashed into a bucket, and
+//	the entries hashing to the same bucket are chained together
+//	through the "next" array.  There are as many buckets as frames
+//	(rounded up to a power of two), so chains stay short.
+//
+//	The memory used is proportional to the size of physical memory,
+//	no matter how many address spaces there are or how large or
+//	sparse they are.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef INVERTEDTABLE_H
+#define INVERTEDTABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "translate.h"
+
+// The following class defines a hashed inverted page table.  Like
+// PageTable, it only records translations; the frames themselves are
+// allocated and freed by the caller.
+
+class InvertedPageTable {
+  public:
+    InvertedPageTable(int numFrames);	// Initialize, nothing mapped
+    ~InvertedPageTable();		// De-allocate the table
+
+    TranslationEntry *Lookup(int space, unsigned int vpn);
+					// Return the entry mapping page
+					// "vpn" of address space "space",
+					// or NULL if it isn't in memory
+    TranslationEntry *Map(int space, unsigned int vpn, int frame,
+			bool readOnly);	// Map "vpn" of "space" to "frame",
+					// which must not be mapped already
+    void Unmap(int frame);		// Remove the mapping of "frame"
+    int UnmapSpace(int space, int *frames);
+					// Remove every mapping of "space",
+					// storing the frames it used in
+					// "frames"; return how many
+
+    int Owner(int frame) { return owner[frame]; }
+					// Address space using "frame",
+					// -1 if none
+
+    void PrintStats() const;		// Print hash chain statistics
+    void SelfTest();			// Test whether this module is working
+
+  private:
+    int Hash(int space, unsigned int vpn) const;
+					// bucket for (space, vpn)
+
+    int numFrames;			// # of entries, one per frame
+    int numBuckets;			// power of two, >= numFrames
+    int bucketBits;			// log2(numBuckets)
+    TranslationEntry *entries;		// entry i translates to frame i
+    int *owner;				// address space of each entry,
+					// -1 if the frame is not mapped
+    int *next;				// next entry in the same chain, -1
+					// at the end of the chain
+    int *bucket;			// first entry of each chain, -1 if
+					// the chain is empty
+    int numMapped;			// # of frames mapped
+
+    // counters, reported by PrintStats
+    int numLookups;			// calls to Lookup
+    int numMisses;			// ... that found nothing
+    int numProbes;			// entries compared by Lookup
+    int longestProbe;			// most entries compared by a
+					// single Lookup
+};
+
+#endif // INVERTEDTABLE_H
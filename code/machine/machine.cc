@@ -63,13 +63,18 @@ Machine::Machine(bool debug)
       	mainMemory[i] = 0;
 #ifdef USE_TLB
     tlb = new TranslationEntry[TLBSize];
-    for (i = 0; i < TLBSize; i++)
+    for (i = 0; i < TLBSize; i++) {
 	tlb[i].valid = FALSE;
+	tlb[i].large = FALSE;
+    }
     pageTable = NULL;
 #else	// use linear page table
     tlb = NULL;
     pageTable = NULL;
 #endif
+    pageDirectory = NULL;
+    invertedTable = NULL;
+    spaceId = -1;
 
     singleStep = debug;
     CheckEndian();
@@ -90,6 +90,8 @@ enum ExceptionType { NoException,           // Everything ok!
 
 class Instruction;
 class Interrupt;
+class PageTable;
+class InvertedPageTable;
 
 class Machine {
   public:
@@ -121,7 +123,10 @@ class Machine {
 //  	a software-loaded translation lookaside buffer (tlb) -- a cache of 
 //	  mappings of virtual page #'s to physical page #'s
 //
-// If "tlb" is NULL, the linear page table is used
+// If "tlb" is NULL, the two-level page table "pageDirectory" is used if
+//	it is set, otherwise the global inverted page table "invertedTable"
+//	(looked up under address space "spaceId") if that is set,
+//	otherwise the linear page table
 // If "tlb" is non-NULL, the Nachos kernel is responsible for managing
 //	the contents of the TLB.  But the kernel can use any data structure
 //	it wants (eg, segmented paging) for handling TLB cache misses.
@@ -138,6 +143,13 @@ class Machine {
     TranslationEntry *pageTable;
     unsigned int pageTableSize;
 
+    PageTable *pageDirectory;		// root of a two-level page table,
+					// used instead of "pageTable"
+					// when not NULL
+
+    InvertedPageTable *invertedTable;	// hashed table shared by all
+    int spaceId;			// address spaces; the one running
+
     bool ReadMem(int addr, int size, int* value);
     bool WriteMem(int addr, int size, int value);
     				// Read or write 1, 2, or 4 bytes of virtual 
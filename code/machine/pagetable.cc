@@ -0,0 +1,180 @@
+// pagetable.cc
+//	Routines to manage a two-level page table.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "pagetable.h"
+
+//----------------------------------------------------------------------
+// PageTable::PageTable
+// 	Initialize an empty page table: no second-level tables, so
+//	no virtual page is mapped.
+//----------------------------------------------------------------------
+
+PageTable::PageTable()
+{
+    for (int i = 0; i < PageDirEntries; i++) {
+	directory[i] = NULL;
+	numValid[i] = 0;
+    }
+    numTables = 0;
+}
+
+//----------------------------------------------------------------------
+// PageTable::~PageTable
+// 	De-allocate the second-level tables.  Any frames still mapped
+//	must have been released by the owner of the page table.
+//----------------------------------------------------------------------
+
+PageTable::~PageTable()
+{
+    for (int i = 0; i < PageDirEntries; i++) {
+	if (directory[i] != NULL) {
+	    delete [] directory[i];
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// PageTable::Lookup
+// 	Walk the table for virtual page "vpn".  Returns NULL if "vpn"
+//	is out of range, or if no page near it has ever been mapped;
+//	otherwise the (possibly invalid) entry for the page.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Lookup(unsigned int vpn)
+{
+    TranslationEntry *table;
+
+    if (vpn >= MaxVirtPages) {
+	return NULL;
+    }
+    table = directory[vpn >> PageTableBits];
+    if (table == NULL) {
+	return NULL;
+    }
+    vpn &= PageTableEntries - 1;
+    if (table[vpn].large) {		// part of a large page
+	vpn &= ~(LargePageRatio - 1);
+    }
+    return &table[vpn];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Leaf
+// 	Return the entry for virtual page "vpn", allocating the
+//	second-level table on first use.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Leaf(unsigned int vpn)
+{
+    int dir = vpn >> PageTableBits;
+
+    ASSERT(vpn < MaxVirtPages);
+    if (directory[dir] == NULL) {
+	TranslationEntry *table = new TranslationEntry[PageTableEntries];
+
+	for (int i = 0; i < PageTableEntries; i++) {
+	    table[i].virtualPage = (dir << PageTableBits) + i;
+	    table[i].physicalPage = -1;
+	    table[i].valid = FALSE;
+	    table[i].readOnly = FALSE;
+	    table[i].use = FALSE;
+	    table[i].dirty = FALSE;
+	    table[i].large = FALSE;
+	}
+	directory[dir] = table;
+	numTables++;
+	DEBUG(dbgAddr, "Allocated page table for pages " << (dir << PageTableBits));
+    }
+    return &directory[dir][vpn & (PageTableEntries - 1)];
+}
+
+//----------------------------------------------------------------------
+// PageTable::Map
+// 	Install a valid translation from virtual page "vpn" to physical
+//	page "frame", allocating the second-level table on first use.
+//
+//	Returns the new entry, so the caller can adjust its bits.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::Map(unsigned int vpn, int frame, bool readOnly)
+{
+    TranslationEntry *entry = Leaf(vpn);
+
+    ASSERT(!entry->large);		// unmap the large page first
+    if (!entry->valid) {
+	numValid[vpn >> PageTableBits]++;
+    }
+    entry->physicalPage = frame;
+    entry->valid = TRUE;
+    entry->readOnly = readOnly;
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// PageTable::MapLarge
+// 	Install a translation for the large page starting at virtual
+//	page "vpn", to the LargePageRatio frames starting at
+//	"firstFrame".  Both must be multiples of LargePageRatio, and
+//	none of the pages may be mapped already.
+//
+//	Returns the new entry, so the caller can adjust its bits.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+PageTable::MapLarge(unsigned int vpn, int firstFrame, bool readOnly)
+{
+    TranslationEntry *entry = Leaf(vpn);
+
+    ASSERT(vpn % LargePageRatio == 0 && firstFrame % LargePageRatio == 0);
+    for (int i = 0; i < LargePageRatio; i++) {
+	ASSERT(!entry[i].valid && !entry[i].large);
+	entry[i].large = TRUE;		// lookups go to the first page
+    }
+    numValid[vpn >> PageTableBits]++;
+    entry->physicalPage = firstFrame;
+    entry->valid = TRUE;
+    entry->readOnly = readOnly;
+    entry->use = FALSE;
+    entry->dirty = FALSE;
+    return entry;
+}
+
+//----------------------------------------------------------------------
+// PageTable::Unmap
+// 	Remove the translation for "vpn", or for the whole large page
+//	it is part of.  When the last valid entry of
+//	a second-level table goes away, the table itself is freed.
+//----------------------------------------------------------------------
+
+void
+PageTable::Unmap(unsigned int vpn)
+{
+    int dir = vpn >> PageTableBits;
+    TranslationEntry *entry = Lookup(vpn);
+
+    if (entry == NULL || !entry->valid) {
+	return;
+    }
+    entry->valid = FALSE;
+    if (entry->large) {
+	for (int i = 0; i < LargePageRatio; i++) {
+	    entry[i].large = FALSE;
+	}
+    }
+    if (--numValid[dir] == 0) {
+	delete [] directory[dir];
+	directory[dir] = NULL;
+	numTables--;
+    }
+}
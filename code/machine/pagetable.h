@@ -0,0 +1,86 @@
+// pagetable.h
+//	Data structures for a two-level page table, mapping a sparse
+//	user virtual address space onto physical page frames.
+//
+//	A virtual page number is split into a directory index (the high
+//	bits) and a table index (the low bits).  The directory is a small
+//	fixed array of pointers; each second-level table holds
+//	PageTableEntries TranslationEntry's and is only allocated once a
+//	page it covers is mapped, and freed again once its last page is
+//	unmapped.  So the memory used by a page table stays proportional
+//	to the memory the address space actually uses, no matter how far
+//	apart its code, heap and stack are.
+//
+//	A large page is recorded in the slot of its first page, with the
+//	"large" bit set; the other slots it covers have only the "large"
+//	bit set, and send lookups back to the first slot.  So one entry,
+//	with one set of use and dirty bits, describes the whole large page.
+//
+//	The same table is walked by the hardware (Machine::Translate)
+//	and by the kernel (AddrSpace::Translate).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PAGETABLE_H
+#define PAGETABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+#include "translate.h"
+
+// Shape of the page table.  With 128 byte pages, 9 directory bits and
+// 8 table bits give each address space a 16MB (24 bit) virtual address
+// space; a second-level table covers 32KB of it.
+
+const int PageDirBits = 9;
+const int PageTableBits = 8;
+const int PageDirEntries = (1 << PageDirBits);
+const int PageTableEntries = (1 << PageTableBits);
+const unsigned int MaxVirtPages = PageDirEntries * PageTableEntries;
+
+// The following class defines a two-level page table.  It only
+// manages the translations; the frames they point to are allocated
+// and freed by the caller.
+
+class PageTable {
+  public:
+    PageTable();			// Initialize, nothing mapped
+    ~PageTable();			// De-allocate all second-level tables
+
+    TranslationEntry *Lookup(unsigned int vpn);
+					// Return the entry for "vpn", or NULL
+					// if its second-level table doesn't
+					// exist.  The entry may be invalid.
+    TranslationEntry *Map(unsigned int vpn, int frame, bool readOnly);
+					// Make "vpn" a valid translation to
+					// "frame", allocating a second-level
+					// table if needed
+    TranslationEntry *MapLarge(unsigned int vpn, int firstFrame,
+			bool readOnly);	// Map the large page starting at
+					// "vpn" to the run of frames
+					// starting at "firstFrame"
+    void Unmap(unsigned int vpn);	// Invalidate "vpn" (or the large
+					// page containing it); free its
+					// second-level table if now empty
+
+    TranslationEntry *Table(int dirIndex) { return directory[dirIndex]; }
+					// Second-level table number
+					// "dirIndex", NULL if not allocated
+    int NumTables() { return numTables; }
+					// # of second-level tables in use
+
+  private:
+    TranslationEntry *Leaf(unsigned int vpn);
+					// Entry for "vpn", allocating its
+					// second-level table if needed
+
+    TranslationEntry *directory[PageDirEntries];
+					// second-level tables, NULL if
+					// nothing in their range is mapped
+    int numValid[PageDirEntries];	// # of valid entries in each table
+    int numTables;			// # of non-NULL directory entries
+};
+
+#endif // PAGETABLE_H
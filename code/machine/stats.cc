@@ -22,6 +22,12 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+    numPagesPrefetched = numPrefetchUseful = numPrefetchWasted = 0;
+    numPagesPreCleaned = 0;
+    numContextSwitches = numUserStateLoads = numSpaceLoads = 0;
+    numDeadlinePeriods = numDeadlineMisses = numAdmissionRejects = 0;
+    numZswapStores = numZswapRejects = numZswapHits = numZswapWritebacks = 0;
+    numZswapBytesIn = numZswapBytesOut = 0;
 }
 
 //----------------------------------------------------------------------
@@ -40,6 +46,34 @@ Statistics::Print()
 		cout << "Console I/O: reads " << numConsoleCharsRead;
     cout << ", writes " << numConsoleCharsWritten << "\n";
     cout << "Paging: faults " << numPageFaults << "\n";
+    if (numContextSwitches > 0) {
+	cout << "Context switches: " << numContextSwitches;
+	cout << ", user register loads " << numUserStateLoads;
+	cout << ", address space loads " << numSpaceLoads << "\n";
+    }
+    if (numDeadlinePeriods + numAdmissionRejects > 0) {
+	cout << "Real-time: periods " << numDeadlinePeriods;
+	cout << ", deadlines missed " << numDeadlineMisses;
+	cout << ", not admitted " << numAdmissionRejects << "\n";
+    }
+    if (numPagesPrefetched > 0) {
+	cout << "Paging: prefetched " << numPagesPrefetched;
+	cout << ", useful " << numPrefetchUseful;
+	cout << ", wasted " << numPrefetchWasted << "\n";
+    }
+    if (numPagesPreCleaned > 0) {
+	cout << "Paging: pre-cleaned " << numPagesPreCleaned << "\n";
+    }
+    if (numZswapStores + numZswapRejects > 0) {
+	cout << "Compressed swap: stored " << numZswapStores;
+	cout << ", rejected " << numZswapRejects;
+	cout << ", written back " << numZswapWritebacks << "\n";
+	cout << "Compressed swap: hits " << numZswapHits << " (";
+	cout << (numPageFaults == 0 ? 0 : 100 * numZswapHits / numPageFaults);
+	cout << "% of faults), compression ratio ";
+	cout << (numZswapBytesOut == 0 ? 0.0 :
+			(double) numZswapBytesIn / numZswapBytesOut) << "\n";
+    }
     cout << "Network I/O: packets received " << numPacketsRecvd;
 		cout << ", sent " << numPacketsSent << "\n";
 }
@@ -33,6 +33,23 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+    int numContextSwitches;	// number of switches between threads
+    int numUserStateLoads;	// ... that had to load user registers
+    int numSpaceLoads;		// ... and a different address space
+    int numDeadlinePeriods;	// periods of real-time threads
+    int numDeadlineMisses;	// ... that ended before they got their
+				// CPU time
+    int numAdmissionRejects;	// real-time threads not admitted
+    int numPagesPrefetched;	// pages read in ahead of a fault
+    int numPrefetchUseful;	// ... that were referenced
+    int numPrefetchWasted;	// ... that were evicted or freed unused
+    int numPagesPreCleaned;	// dirty pages written back while idle
+    int numZswapStores;		// evicted pages kept compressed in memory
+    int numZswapRejects;	// ... and those that didn't compress
+    int numZswapHits;		// page faults served from the pool
+    int numZswapWritebacks;	// pool pages written to disk for room
+    int numZswapBytesIn;	// bytes stored, before compression
+    int numZswapBytesOut;	// ... and after
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
@@ -55,6 +72,8 @@ const int RotationTime = 500; 	// time disk takes to rotate one sector
 const int SeekTime =	 500;  	// time disk takes to seek past one track
 const int ConsoleTime =	 100;	// time to read or write one character
 const int NetworkTime =	 100;  	// time to send or receive one packet
+const int CompressTime =  20;	// time to compress one page
+const int DecompressTime = 10;	// time to decompress one page
 
 /* MP3 RR Quentam --> 110(total tick) - 10(re-enable intterrupt --> system tick += 10) = 100(user tick) */
 const int TimerTicks = 	 110;  	// (average) time between timer interrupts
@@ -31,6 +31,8 @@
 
 #include "copyright.h"
 #include "main.h"
+#include "pagetable.h"
+#include "invertedtable.h"
 
 // Routines for converting Words and Short Words to and from the
 // simulated machine's format of little endian.  These end up
@@ -197,15 +199,33 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	return AddressErrorException;
     }
     // we must have either a TLB or a page table, but not both!
-    ASSERT(tlb == NULL || pageTable == NULL);	
-    ASSERT(tlb != NULL || pageTable != NULL);	
+    ASSERT(tlb == NULL ||
+	(pageTable == NULL && pageDirectory == NULL && invertedTable == NULL));
+    ASSERT(tlb != NULL || pageTable != NULL || pageDirectory != NULL ||
+	invertedTable != NULL);
 
 // calculate the virtual page number, and offset within the page,
 // from the virtual address
     vpn = (unsigned) virtAddr / PageSize;
     offset = (unsigned) virtAddr % PageSize;
     
-    if (tlb == NULL) {		// => page table => vpn is index into table
+    if (tlb == NULL && pageDirectory != NULL) {	// => two-level table
+	if (vpn >= MaxVirtPages) {
+	    DEBUG(dbgAddr, "Illegal virtual page # " << virtAddr);
+	    return AddressErrorException;
+	}
+	entry = pageDirectory->Lookup(vpn);
+	if (entry == NULL || !entry->valid) {
+	    DEBUG(dbgAddr, "Invalid virtual page # " << virtAddr);
+	    return PageFaultException;
+	}
+    } else if (tlb == NULL && invertedTable != NULL) {	// => hashed lookup
+	entry = invertedTable->Lookup(spaceId, vpn);
+	if (entry == NULL) {
+	    DEBUG(dbgAddr, "Virtual page # " << virtAddr << " not in memory");
+	    return PageFaultException;
+	}
+    } else if (tlb == NULL) {	// => page table => vpn is index into table
 	if (vpn >= pageTableSize) {
 	    DEBUG(dbgAddr, "Illegal virtual page # " << virtAddr);
 	    return AddressErrorException;
@@ -216,7 +236,9 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	entry = &pageTable[vpn];
     } else {
         for (entry = NULL, i = 0; i < TLBSize; i++)
-    	    if (tlb[i].valid && (tlb[i].virtualPage == ((int)vpn))) {
+    	    if (tlb[i].valid && (tlb[i].virtualPage == ((int)vpn) ||
+		    (tlb[i].large && tlb[i].virtualPage ==
+			(int)(vpn & ~(LargePageRatio - 1))))) {
 		entry = &tlb[i];			// FOUND!
 		break;
 	    }
@@ -233,6 +255,8 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	return ReadOnlyException;
     }
     pageFrame = entry->physicalPage;
+    if (entry->large)			// one entry covers the large page
+	pageFrame += vpn - entry->virtualPage;
 
     // if the pageFrame is too big, there is something really wrong! 
     // An invalid translation was loaded into the page table or TLB. 
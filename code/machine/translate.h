@@ -21,9 +21,15 @@
 #include "copyright.h"
 #include "utility.h"
 
+// A large page (superpage) is LargePageRatio consecutive pages, starting
+// at a page number that is a multiple of LargePageRatio, both in virtual
+// and in physical memory.
+
+const int LargePageRatio = 16;
+
 // The following class defines an entry in a translation table -- either
 // in a page table or a TLB.  Each entry defines a mapping from one 
-// virtual page to one physical page.
+// virtual page to one physical page, or from one large page to another.
 // In addition, there are some extra bits for access control (valid and 
 // read-only) and some bits for usage information (use and dirty).
 
@@ -40,6 +46,9 @@ class TranslationEntry {
 			// page is referenced or modified.
     bool dirty;         // This bit is set by the hardware every time the
 			// page is modified.
+    bool large;		// If this bit is set, the entry maps a whole large
+			// page; virtualPage and physicalPage are the first
+			// page of each.
 };
 
 #endif
@@ -0,0 +1,33 @@
+#include "syscall.h"
+
+int main(void)
+{
+	char test[] = "abcdefghijklmnopqrstuvwxyz";
+	char back[26];
+	int success = Create("file2.test");
+	OpenFileId fid;
+	int req, count, i;
+	if (success != 1) MSG("Failed on creating file");
+	fid = Open("file2.test");
+	if (fid <= 0) MSG("Failed on opening file");
+	req = AsyncWrite(test, 26, fid);
+	if (req < 0) MSG("Failed on starting write");
+	/* compute while the write is in progress */
+	for (count = 0, i = 0; i < 1000; i++)
+		count += i;
+	if (PollIO(req) < 0) MSG("Failed on polling write");
+	if (WaitIO(req) != 26) MSG("Failed on writing file");
+	if (WaitIO(req) != -1) MSG("Failed on collecting twice");
+	success = Close(fid);
+	if (success != 1) MSG("Failed on closing file");
+
+	fid = Open("file2.test");
+	if (fid <= 0) MSG("Failed on opening file");
+	req = AsyncRead(back, 26, fid);
+	if (WaitIO(req) != 26) MSG("Failed on reading file");
+	for (i = 0; i < 26; ++i)
+		if (back[i] != test[i]) MSG("Failed on reading back");
+	success = Close(fid);
+	if (success != 1) MSG("Failed on closing file");
+	Halt();
+}
@@ -0,0 +1,48 @@
+#include "syscall.h"
+
+int main(void)
+{
+	char test[] = "abcdefghijklmnopqrstuvwxyz";
+	char back[26];
+	int success = Create("file3.test");
+	OpenFileId fid;
+	char *map;
+	int i;
+	if (success != 1) MSG("Failed on creating file");
+	fid = Open("file3.test");
+	if (fid <= 0) MSG("Failed on opening file");
+	if (Write(test, 26, fid) != 26) MSG("Failed on writing file");
+
+	/* upper-case the file in place, through memory */
+	map = Mmap(fid, 0, 26);
+	if (map == 0) MSG("Failed on mapping file");
+	for (i = 0; i < 26; ++i) {
+		if (map[i] != test[i]) MSG("Failed on reading mapping");
+		map[i] = map[i] - 'a' + 'A';
+	}
+	if (Munmap(map) != 1) MSG("Failed on unmapping file");
+	if (Munmap(map) != -1) MSG("Failed on unmapping twice");
+
+	Seek(0, fid);
+	if (Read(back, 26, fid) != 26) MSG("Failed on reading file");
+	for (i = 0; i < 26; ++i)
+		if (back[i] != test[i] - 'a' + 'A') MSG("Failed on writing back");
+
+	/* a mapping outlives closing its file, and writes back to it,
+	 * not to the file opened next */
+	map = Mmap(fid, 0, 26);
+	if (map == 0) MSG("Failed on mapping file");
+	map[0] = '*';
+	success = Close(fid);
+	if (success != 1) MSG("Failed on closing file");
+	if (Create("file4.test") != 1) MSG("Failed on creating file");
+	fid = Open("file4.test");
+	if (fid <= 0) MSG("Failed on opening file");
+	if (Munmap(map) != 1) MSG("Failed on unmapping closed file");
+	if (Read(back, 26, fid) != 0) MSG("Failed on writing back to the closed file");
+	Close(fid);
+	fid = Open("file3.test");
+	if (Read(back, 1, fid) != 1 || back[0] != '*') MSG("Failed on writing back after close");
+	Close(fid);
+	Halt();
+}
@@ -0,0 +1,53 @@
+#include "syscall.h"
+
+IoRing ring;
+
+/* Queue a request; the caller runs the ring before it fills up. */
+void Queue(int op, int id, char *addr, int size)
+{
+	RingRequest *r;
+
+	r = &ring.sq[ring.sqTail % RingSize];
+	r->op = op;
+	r->id = id;
+	r->addr = (int) addr;
+	r->size = size;
+	r->userData = ring.sqTail;
+	ring.sqTail++;
+}
+
+/* Check and consume every completion. */
+void Reap(int expect)
+{
+	while (ring.cqHead != ring.cqTail) {
+		if (ring.cq[ring.cqHead % RingSize].result != expect)
+			MSG("Failed on ring request");
+		ring.cqHead++;
+	}
+}
+
+int main(void)
+{
+	char test[] = "abcdefghijklmnopqrstuvwxyz";
+	int success = Create("file1.test");
+	OpenFileId fid;
+	int i;
+	if (success != 1) MSG("Failed on creating file");
+	if (RegisterRing(&ring) != 1) MSG("Failed on registering ring");
+	fid = Open("file1.test");
+	if (fid <= 0) MSG("Failed on opening file");
+	/* the same 26 one-byte writes as fileIO_test1, one trap per ring */
+	for (i = 0; i < 26; ++i) {
+		Queue(RingWrite, fid, test + i, 1);
+		if (ring.sqTail - ring.sqHead == RingSize) {
+			SubmitAndWait();
+			Reap(1);
+		}
+	}
+	SubmitAndWait();
+	Reap(1);
+	Queue(RingClose, fid, 0, 0);
+	if (SubmitAndWait() != 1) MSG("Failed on closing file");
+	Reap(1);
+	Halt();
+}
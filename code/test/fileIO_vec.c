@@ -0,0 +1,35 @@
+#include "syscall.h"
+
+int main(void)
+{
+	char header[] = "rec:";
+	char payload[] = "abcdefghijklmnopqrstuvwxyz";
+	char h[4], p[26];
+	IoVec vec[2];
+	int success = Create("file4.test");
+	OpenFileId fid;
+	int i;
+	if (success != 1) MSG("Failed on creating file");
+	fid = Open("file4.test");
+	if (fid <= 0) MSG("Failed on opening file");
+
+	/* a record is a header plus a payload, written with one trap */
+	vec[0].addr = (int) header;
+	vec[0].size = 4;
+	vec[1].addr = (int) payload;
+	vec[1].size = 26;
+	for (i = 0; i < 3; ++i)
+		if (WriteV(vec, 2, fid) != 30) MSG("Failed on writing record");
+
+	Seek(30, fid);
+	vec[0].addr = (int) h;
+	vec[1].addr = (int) p;
+	if (ReadV(vec, 2, fid) != 30) MSG("Failed on reading record");
+	for (i = 0; i < 4; ++i)
+		if (h[i] != header[i]) MSG("Failed on reading header");
+	for (i = 0; i < 26; ++i)
+		if (p[i] != payload[i]) MSG("Failed on reading payload");
+	success = Close(fid);
+	if (success != 1) MSG("Failed on closing file");
+	Halt();
+}
@@ -0,0 +1,30 @@
+#include "syscall.h"
+#include "malloc.h"
+
+int main(void)
+{
+	int *a[16];
+	int i, j;
+	char *end;
+
+	/* the heap starts out empty, and grows on demand */
+	for (i = 0; i < 16; ++i) {
+		a[i] = (int *) malloc(100 * sizeof(int));
+		if (a[i] == 0) MSG("Failed on malloc");
+		for (j = 0; j < 100; ++j)
+			a[i][j] = i;
+	}
+	for (i = 0; i < 16; ++i)
+		for (j = 0; j < 100; ++j)
+			if (a[i][j] != i) MSG("Failed on heap contents");
+
+	/* freed blocks merge, and are reused before the heap grows */
+	for (i = 0; i < 16; i += 2)
+		free(a[i]);
+	for (i = 1; i < 16; i += 2)
+		free(a[i]);
+	end = Sbrk(0);
+	if (malloc(1600 * sizeof(int)) == 0 || Sbrk(0) != end)
+		MSG("Failed on reusing the heap");
+	Halt();
+}
@@ -0,0 +1,26 @@
+#include "syscall.h"
+
+#define PageSize	128
+#define WordsPerPage	(PageSize / 4)
+#define BigPages	192	/* more than fits in physical memory */
+#define HeapPages	8
+
+int big[BigPages * WordsPerPage];
+
+/* run with -dp: filling "big" pages some of it out, and the new heap
+ * pages get the frames it had; they must still read as zero */
+int main(void)
+{
+	int *heap;
+	int i;
+
+	for (i = 0; i < BigPages * WordsPerPage; ++i)
+		big[i] = i + 1;
+	heap = (int *) Sbrk(HeapPages * PageSize);
+	if (heap == (int *) -1) MSG("Failed on Sbrk");
+	for (i = 0; i < HeapPages * WordsPerPage; ++i)
+		if (heap[i] != 0) MSG("Failed on zeroing the heap");
+	for (i = 0; i < BigPages * WordsPerPage; i += WordsPerPage)
+		if (big[i] != i + 1) MSG("Failed on paging");
+	Halt();
+}
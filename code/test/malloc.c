@@ -0,0 +1,105 @@
+/* malloc.c
+ *	A small memory allocator for user programs.
+ *
+ *	Free blocks are kept on a list sorted by address.  malloc takes
+ *	the first free block big enough (splitting it if it is much too
+ *	big), and only asks the kernel for more heap, with Sbrk, when no
+ *	block fits.  free puts a block back in order, and merges it with
+ *	the free blocks right before and after it, so the heap doesn't
+ *	fragment into blocks too small to use.
+ *
+ *	Every block starts with a header giving its size, including the
+ *	header, in units of the header size (8 bytes).
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#include "syscall.h"
+#include "malloc.h"
+
+typedef struct header {
+    struct header *next;	/* next free block, if this one is free */
+    int units;			/* size of the block, header included */
+} Header;
+
+#define MinGrow		128	/* units to ask Sbrk for at least (1KB) */
+
+static Header *freeList = 0;	/* free blocks, sorted by address */
+
+/* Return the block "b" to the free list, merging it with its free
+ * neighbours.
+ */
+void free(void *ptr)
+{
+    Header *b = (Header *) ptr - 1;
+    Header *prev = 0, *p = freeList;
+
+    if (ptr == 0)
+	return;
+    while (p != 0 && p < b) {
+	prev = p;
+	p = p->next;
+    }
+    if (p != 0 && b + b->units == p) {		/* merge with the next */
+	b->units += p->units;
+	b->next = p->next;
+    } else {
+	b->next = p;
+    }
+    if (prev != 0 && prev + prev->units == b) {	/* and the previous */
+	prev->units += b->units;
+	prev->next = b->next;
+    } else if (prev != 0) {
+	prev->next = b;
+    } else {
+	freeList = b;
+    }
+}
+
+/* Get at least "units" more units from the kernel, as a free block.
+ * Return 0 if the heap is full.
+ */
+static int grow(int units)
+{
+    Header *b;
+
+    if (units < MinGrow)
+	units = MinGrow;
+    b = (Header *) Sbrk(units * sizeof(Header));
+    if (b == (Header *) -1)
+	return 0;
+    b->units = units;
+    free(b + 1);
+    return 1;
+}
+
+void *malloc(int size)
+{
+    int units = (size + sizeof(Header) - 1) / sizeof(Header) + 1;
+    Header *prev, *p;
+
+    if (size <= 0)
+	return 0;
+    for (;;) {
+	prev = 0;
+	for (p = freeList; p != 0; prev = p, p = p->next) {
+	    if (p->units < units)
+		continue;
+	    if (p->units == units) {		/* exact fit */
+		if (prev != 0)
+		    prev->next = p->next;
+		else
+		    freeList = p->next;
+	    } else {				/* give away the tail */
+		p->units -= units;
+		p += p->units;
+		p->units = units;
+	    }
+	    return (void *) (p + 1);
+	}
+	if (!grow(units))
+	    return 0;
+    }
+}
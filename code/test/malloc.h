@@ -0,0 +1,21 @@
+/* malloc.h
+ *	A small memory allocator for user programs, on top of the Sbrk
+ *	system call.  Link malloc.o after start.o to use it.
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#ifndef MALLOC_H
+#define MALLOC_H
+
+/* Return "size" bytes of memory, 8 byte aligned, or 0 if the heap is
+ * full.  Memory fresh from Sbrk is zero; reused memory is not.
+ */
+void *malloc(int size);
+
+/* Give back memory returned by malloc. */
+void free(void *ptr);
+
+#endif /* MALLOC_H */
@@ -0,0 +1,41 @@
+#include "syscall.h"
+
+int main(void)
+{
+	OpenFileId ends[2];
+	char out[300], in[300];
+	int i, n, total;
+	SpaceId pid;
+
+	if (Pipe(ends) != 0) MSG("Failed on creating pipe");
+	for (i = 0; i < 300; ++i)
+		out[i] = 'a' + i % 26;
+	if (Write(out, 300, ends[1]) != 300) MSG("Failed on writing pipe");
+	if (Write(out, 1, ends[0]) != -1) MSG("Failed on writing read end");
+
+	/* reads take what is there, in order, in any pieces */
+	for (total = 0; total < 300; total += n) {
+		n = Read(in + total, 100, ends[0]);
+		if (n <= 0) MSG("Failed on reading pipe");
+	}
+	for (i = 0; i < 300; ++i)
+		if (in[i] != out[i]) MSG("Failed on pipe contents");
+
+	/* reading nothing doesn't wait for data */
+	if (Read(in, 0, ends[0]) != 0) MSG("Failed on reading 0 bytes");
+
+	/* with the write end closed, an empty pipe is at end of file */
+	Close(ends[1]);
+	if (Read(in, 1, ends[0]) != 0) MSG("Failed on end of file");
+	Close(ends[0]);
+	if (Read(in, 1, ends[0]) != -1) MSG("Failed on closing pipe");
+
+	/* a child holds our ends too, and closes them when it exits */
+	if (Pipe(ends) != 0) MSG("Failed on creating pipe");
+	pid = Exec("../test/child");
+	Close(ends[1]);
+	if (Join(pid) != 7) MSG("Failed on Join");
+	if (Read(in, 1, ends[0]) != 0) MSG("Failed on end of file after exit");
+	Close(ends[0]);
+	Halt();
+}
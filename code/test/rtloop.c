@@ -0,0 +1,69 @@
+#include "syscall.h"
+
+#define NumPeriods	20
+
+int steps[3];
+int missed[3];
+
+/* a control loop: a step of work every period, then wait for the next;
+ * if "print", each step writes to the console too, and blocks on it */
+int loop(int which, int period, int budget, int print)
+{
+	int i, j, x = 0;
+
+	if (SetDeadline(period, budget) < 0) {
+		MSG("Failed on SetDeadline");
+		return -1;
+	}
+	for (i = 0; i < NumPeriods; ++i) {
+		for (j = 0; j < 20; ++j)
+			x += j;
+		if (print)
+			PrintInt(i);
+		steps[which]++;
+		ThreadYield();
+	}
+	missed[which] = SetDeadline(0, 0);
+	return x;
+}
+
+int fast() { return loop(0, 1000, 300, 0); }
+int slow() { return loop(1, 3000, 600, 0); }
+int talk() { return loop(2, 3000, 300, 1); }
+
+/* and something that wants the CPU all the time */
+int hog()
+{
+	int i, x = 0;
+
+	for (i = 0; i < 20000; ++i)
+		x += i;
+	return x;
+}
+
+int main(void)
+{
+	ThreadId id[4];
+	int i;
+
+	if (SetDeadline(1000, 2000) != -1) MSG("Failed on a budget over the period");
+	if (SetDeadline(100, 95) != -1) MSG("Failed on admission control");
+
+	id[0] = ThreadFork((void (*)()) hog);
+	id[1] = ThreadFork((void (*)()) fast);
+	id[2] = ThreadFork((void (*)()) slow);
+	id[3] = ThreadFork((void (*)()) talk);
+	for (i = 0; i < 4; ++i) {
+		if (id[i] < 0) MSG("Failed on ThreadFork");
+		ThreadJoin(id[i]);
+	}
+	for (i = 0; i < 3; ++i) {
+		if (steps[i] != NumPeriods)
+			MSG("Failed on the control loops");
+		if (missed[i] != 0)
+			MSG("Failed on a deadline");
+	}
+	/* the statistics at the end must say "deadlines missed 0, not
+	 * admitted 1": the loops fit, and SetDeadline(100, 95) did not */
+	MSG("All control loops done");
+}
@@ -0,0 +1,16 @@
+/* shm.h
+ *	The bounded buffer shared by shm_producer and shm_consumer.
+ *	Run them together: nachos -e shm_producer -e shm_consumer
+ */
+
+#include "ulock.h"
+
+#define ShmKey		42
+#define BufferSize	8
+#define NumItems	100
+
+typedef struct {
+	USemaphore empty;	/* free slots */
+	USemaphore full;	/* slots holding an item */
+	int buffer[BufferSize];
+} BoundedBuffer;
@@ -0,0 +1,25 @@
+#include "syscall.h"
+#include "shm.h"
+
+int main(void)
+{
+	BoundedBuffer *b;
+	int i, sum = 0;
+
+	b = (BoundedBuffer *) ShmAttach(ShmCreate(ShmKey, sizeof(BoundedBuffer)));
+	if (b == 0) {
+		MSG("Failed on ShmAttach");
+		Halt();
+	}
+	for (i = 1; i <= NumItems; ++i) {
+		SemP(&b->full, 1);
+		if (b->buffer[i % BufferSize] != i)
+			MSG("Failed on shared memory contents");
+		sum += b->buffer[i % BufferSize];
+		SemV(&b->empty, 1);
+	}
+	if (sum != NumItems * (NumItems + 1) / 2)
+		MSG("Failed on the sum");
+	MSG("Consumer done");
+	Exit(0);
+}
@@ -0,0 +1,29 @@
+#include "syscall.h"
+#include "shm.h"
+
+int main(void)
+{
+	BoundedBuffer *b;
+	int i;
+
+	b = (BoundedBuffer *) ShmAttach(ShmCreate(ShmKey, sizeof(BoundedBuffer)));
+	if (b == 0) {
+		MSG("Failed on ShmAttach");
+		Halt();
+	}
+	/* every slot starts out free */
+	for (i = 0; i < BufferSize; ++i)
+		SemV(&b->empty, 0);
+	for (i = 1; i <= NumItems; ++i) {
+		SemP(&b->empty, 0);
+		b->buffer[i % BufferSize] = i;
+		SemV(&b->full, 0);
+	}
+	/* wait until the consumer took everything, before detaching */
+	for (i = 0; i < BufferSize; ++i)
+		SemP(&b->empty, 0);
+	if (ShmDetach((char *) b) != 1)
+		MSG("Failed on ShmDetach");
+	MSG("Producer done");
+	Exit(0);
+}
@@ -0,0 +1,26 @@
+#include "syscall.h"
+
+#define Rounds	50
+#define Batch	4
+
+int main(void)
+{
+	SpaceId pid[Batch], first = -1;
+	int i, j;
+
+	/* the pids of joined children are reused, so the table stays small */
+	for (i = 0; i < Rounds; ++i) {
+		for (j = 0; j < Batch; ++j) {
+			pid[j] = Exec("../test/child");
+			if (pid[j] < 0) MSG("Failed on Exec");
+		}
+		if (first == -1)
+			first = pid[0];
+		else if (pid[0] != first)
+			MSG("Failed on reusing pids");
+		for (j = 0; j < Batch; ++j)
+			if (Join(pid[j]) != 7) MSG("Failed on Join");
+		if (Join(pid[0]) != -1) MSG("Failed on joining twice");
+	}
+	MSG("Spawned all children");
+}
@@ -0,0 +1,62 @@
+/* ulock.c
+ *	Bakery locks, and semaphores built on them, for user programs
+ *	sharing memory.  See ulock.h.
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#include "syscall.h"
+#include "ulock.h"
+
+/* Take a ticket one higher than any other, then wait for every
+ * program with a lower ticket (or the same ticket and a lower
+ * number) to go first.  Waiting yields the CPU: the holder can't
+ * release the lock unless it runs.
+ */
+void SpinLockAcquire(SpinLock *l, int me)
+{
+	int i, max = 0;
+
+	l->choosing[me] = 1;
+	for (i = 0; i < MaxLockers; ++i)
+		if (l->number[i] > max)
+			max = l->number[i];
+	l->number[me] = max + 1;
+	l->choosing[me] = 0;
+
+	for (i = 0; i < MaxLockers; ++i) {
+		while (l->choosing[i])
+			ThreadYield();
+		while (l->number[i] != 0 && (l->number[i] < l->number[me]
+				|| (l->number[i] == l->number[me] && i < me)))
+			ThreadYield();
+	}
+}
+
+void SpinLockRelease(SpinLock *l, int me)
+{
+	l->number[me] = 0;
+}
+
+void SemP(USemaphore *s, int me)
+{
+	for (;;) {
+		SpinLockAcquire(&s->lock, me);
+		if (s->value > 0) {
+			s->value--;
+			SpinLockRelease(&s->lock, me);
+			return;
+		}
+		SpinLockRelease(&s->lock, me);
+		ThreadYield();
+	}
+}
+
+void SemV(USemaphore *s, int me)
+{
+	SpinLockAcquire(&s->lock, me);
+	s->value++;
+	SpinLockRelease(&s->lock, me);
+}
@@ -0,0 +1,44 @@
+/* ulock.h
+ *	Locks and semaphores for user programs sharing memory (see
+ *	ShmAttach).  They live in the shared segment itself, and need
+ *	no system call but ThreadYield, to let the other programs run
+ *	while waiting.  Link ulock.o after start.o to use them.
+ *
+ *	The simulated MIPS has no atomic read-modify-write instruction,
+ *	so the lock is Lamport's bakery algorithm, which needs only
+ *	plain loads and stores.  Each program using a lock passes its
+ *	own number, from 0 to MaxLockers-1, to every call.
+ *
+ *	A lock or semaphore starts out zeroed, as shared memory does:
+ *	a zero lock is free, and a zero semaphore has value 0.
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#ifndef ULOCK_H
+#define ULOCK_H
+
+#define MaxLockers	8		/* programs that may use a lock */
+
+typedef struct {
+    volatile int choosing[MaxLockers];	/* taking a number */
+    volatile int number[MaxLockers];	/* ticket, 0 if not waiting */
+} SpinLock;
+
+typedef struct {
+    SpinLock lock;			/* protects value */
+    volatile int value;
+} USemaphore;
+
+void SpinLockAcquire(SpinLock *l, int me);
+void SpinLockRelease(SpinLock *l, int me);
+
+/* Wait until the value is positive, then decrement it. */
+void SemP(USemaphore *s, int me);
+
+/* Increment the value. */
+void SemV(USemaphore *s, int me);
+
+#endif /* ULOCK_H */
@@ -0,0 +1,47 @@
+#include "syscall.h"
+
+#define N		1024
+#define NumWorkers	4
+
+int data[N];
+int partial[NumWorkers];
+
+/* each worker sums its quarter of the shared array, and returns it */
+int work(int w)
+{
+	int i, sum = 0;
+
+	for (i = w * (N / NumWorkers); i < (w + 1) * (N / NumWorkers); ++i) {
+		sum += data[i];
+		if (i % 64 == 0)
+			ThreadYield();
+	}
+	partial[w] = sum;
+	return sum;
+}
+
+int worker0() { return work(0); }
+int worker1() { return work(1); }
+int worker2() { return work(2); }
+int worker3() { ThreadExit(work(3)); }
+
+int main(void)
+{
+	int (*worker[NumWorkers])() = { worker0, worker1, worker2, worker3 };
+	ThreadId id[NumWorkers];
+	int i, total = 0;
+
+	for (i = 0; i < N; ++i)
+		data[i] = i;
+	for (i = 0; i < NumWorkers; ++i) {
+		id[i] = ThreadFork((void (*)()) worker[i]);
+		if (id[i] < 0) MSG("Failed on ThreadFork");
+	}
+	for (i = 0; i < NumWorkers; ++i) {
+		if (ThreadJoin(id[i]) != partial[i]) MSG("Failed on ThreadJoin");
+		total += partial[i];
+	}
+	if (ThreadJoin(id[0]) != -1) MSG("Failed on joining twice");
+	if (total != N * (N - 1) / 2) MSG("Failed on the sum");
+	MSG("All threads joined");
+}
@@ -17,6 +17,15 @@
 #include "synchdisk.h"
 #include "post.h"
 #include "synchconsole.h"
+#include "frametable.h"
+#include "invertedtable.h"
+#include "swap.h"
+#include "compresscache.h"
+#include "syscalltable.h"
+#include "sharedmem.h"
+#include "pipe.h"
+#include "process.h"
+#include "stackpool.h"
 
 //----------------------------------------------------------------------
 // Kernel::Kernel
@@ -28,6 +37,11 @@ Kernel::Kernel(int argc, char **argv)
 {
     randomSlice = FALSE;
     debugUserProg = FALSE;
+    useInvertedTable = FALSE;
+    largePages = FALSE;
+    demandPaging = FALSE;
+    compressSwap = FALSE;
+    schedPolicy = "mlfq";
     consoleIn = NULL;          // default is stdin
     consoleOut = NULL;         // default is stdout
 
@@ -37,6 +51,9 @@ Kernel::Kernel(int argc, char **argv)
     reliability = 1;            // network reliability, default is 1.0
     hostName = 0;               // machine id, also UNIX socket name
                                 // 0 is the default machine id
+    execfile = new char*[argc];	// at most one program per argument
+    execpriority = new int[argc];
+    execfileNum = 0;
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-rs") == 0) {
  	    	ASSERT(i + 1 < argc);
@@ -46,8 +63,20 @@ Kernel::Kernel(int argc, char **argv)
 	    	i++;
         } else if (strcmp(argv[i], "-s") == 0) {
             debugUserProg = TRUE;
+        } else if (strcmp(argv[i], "-ipt") == 0) {
+            useInvertedTable = TRUE;
+        } else if (strcmp(argv[i], "-lp") == 0) {
+            largePages = TRUE;
+        } else if (strcmp(argv[i], "-dp") == 0) {
+            demandPaging = TRUE;
+        } else if (strcmp(argv[i], "-zswap") == 0) {
+            compressSwap = TRUE;
+        } else if (strcmp(argv[i], "-sched") == 0) {
+            ASSERT(i + 1 < argc);
+            schedPolicy = argv[++i];
 		} else if (strcmp(argv[i], "-e") == 0) {
         	execfile[++execfileNum]= argv[++i];
+            execpriority[execfileNum] = 0;
 			cout << execfile[execfileNum] << "\n";
 		}
 
@@ -55,7 +84,7 @@ Kernel::Kernel(int argc, char **argv)
         else if (strcmp(argv[i], "-ep") == 0)
         {
         	execfile[++execfileNum]= argv[++i];
-            execpriority[++execpriorityNum] = atoi(argv[++i]);
+            execpriority[execfileNum] = atoi(argv[++i]);
 			cout << execfile[execfileNum] << "\n";
 		}
 
@@ -82,6 +111,8 @@ Kernel::Kernel(int argc, char **argv)
         } else if (strcmp(argv[i], "-u") == 0) {
             cout << "Partial usage: nachos [-rs randomSeed]\n";
 	   		cout << "Partial usage: nachos [-s]\n";
+	   		cout << "Partial usage: nachos [-ipt] [-lp] [-dp [-zswap]]\n";
+	   		cout << "Partial usage: nachos [-sched mlfq|rr|fifo|sjf|cfs]\n";
             cout << "Partial usage: nachos [-ci consoleIn] [-co consoleOut]\n";
 #ifndef FILESYS_STUB
 	    	cout << "Partial usage: nachos [-nf]\n";
@@ -106,21 +137,45 @@ Kernel::Initialize()
     // object to save its state.
 
 
+    stackPool = new StackPool(StackSize * sizeof(int));
     currentThread = new Thread("main", threadNum++);
     currentThread->setStatus(RUNNING);
 
     stats = new Statistics();		// collect statistics
     interrupt = new Interrupt;		// start up interrupt handling
-    scheduler = new Scheduler();	// initialize the ready queue
+    SchedulingPolicy *policy = NewSchedulingPolicy(schedPolicy);
+    if (policy == NULL) {
+        cerr << "Unknown scheduling policy: " << schedPolicy << "\n";
+        Exit(1);
+    }
+    scheduler = new Scheduler(policy);	// initialize the ready queue
     alarm = new Alarm(randomSlice);	// start up time slicing
     machine = new Machine(debugUserProg);
     synchConsoleIn = new SynchConsoleInput(consoleIn); // input from stdin
     synchConsoleOut = new SynchConsoleOutput(consoleOut); // output to stdout
     synchDisk = new SynchDisk();    //
 
-    // MP2 Initilize freeFrameList
-    freeFrameList = new List<int>;
-    for(int i=0 ; i<NumPhysPages ; i++) freeFrameList->Append(i);
+    // MP2 all physical frames start out free
+    frameTable = new FrameTable(NumPhysPages);
+    if (useInvertedTable) {
+        invertedTable = new InvertedPageTable(NumPhysPages);
+    } else {
+        invertedTable = NULL;
+    }
+    swapSpace = NULL;
+    compressedCache = NULL;
+#ifdef FILESYS_STUB
+    if (demandPaging) {		// the disk is free, swap to it
+        swapSpace = new SwapSpace(synchDisk);
+        if (compressSwap)	// pool of a quarter of physical memory
+            compressedCache = new CompressedCache(MemorySize / 4);
+    }
+#endif
+    syscallTable = new SyscallTable(syscallDesc, numSyscallDesc);
+    sharedMemory = new SharedMemory();
+    pipes = new List<Pipe *>;
+    mappedFiles = new List<OpenFile *>;
+    processTable = new ProcessTable();
 
 #ifdef FILESYS_STUB
     fileSystem = new FileSystem();
@@ -140,6 +195,10 @@ Kernel::Initialize()
 
 Kernel::~Kernel()
 {
+    while (!pipes->IsEmpty())		// nobody can be waiting now
+        delete pipes->RemoveFront();
+    delete pipes;
+    delete mappedFiles;
     delete stats;
     delete interrupt;
     delete scheduler;
@@ -148,6 +207,19 @@ Kernel::~Kernel()
     delete synchConsoleIn;
     delete synchConsoleOut;
     delete synchDisk;
+    delete frameTable;
+    if (invertedTable != NULL)
+        delete invertedTable;
+    if (compressedCache != NULL)
+        delete compressedCache;
+    if (swapSpace != NULL)
+        delete swapSpace;
+    delete syscallTable;
+    delete sharedMemory;
+    delete processTable;
+    delete [] execfile;
+    delete [] execpriority;
+    delete stackPool;
     delete fileSystem;
     delete postOfficeIn;
     delete postOfficeOut;
@@ -164,6 +236,9 @@ void
 Kernel::ThreadSelfTest() {
    Semaphore *semaphore;
    SynchList<int> *synchList;
+   FrameTable *frames;
+   InvertedPageTable *inverted;
+   FairQueue *fair;
 
    LibSelfTest();		// test library routines
 
@@ -180,6 +255,21 @@ Kernel::ThreadSelfTest() {
    synchList->SelfTest(9);
    delete synchList;
 
+   				// test physical frame allocation
+   frames = new FrameTable(NumPhysPages);
+   frames->SelfTest();
+   delete frames;
+
+   				// test hashed page table lookups
+   inverted = new InvertedPageTable(NumPhysPages);
+   inverted->SelfTest();
+   delete inverted;
+
+   				// test the fair scheduler's tree
+   fair = new FairQueue;
+   fair->SelfTest();
+   delete fair;
+
 }
 
 //----------------------------------------------------------------------
@@ -264,16 +354,6 @@ Kernel::NetworkTest() {
     // Then we're done!
 }
 
-void ForkExecute(Thread *t)
-{
-	if ( !t->space->Load(t->getName()) ) {
-    	return;             // executable not found
-    }
-
-    t->space->Execute(t->getName());
-
-}
-
 void Kernel::ExecAll()
 {
     /* MP3 threadNum conflict with postal */
@@ -289,12 +369,7 @@ void Kernel::ExecAll()
 
 int Kernel::Exec(char* name, int priority)
 {
-	t[threadNum] = new Thread(name, threadNum, priority);
-	t[threadNum]->space = new AddrSpace();
-	t[threadNum]->Fork((VoidFunctionPtr) &ForkExecute, (void *)t[threadNum]);
-	threadNum++;
-
-	return threadNum-1;
+	return processTable->Exec(name, priority, -1);	// no parent
 /*
     cout << "Total threads number is " << execfileNum << endl;
     for (int n=1;n<=execfileNum;n++) {
@@ -369,6 +444,10 @@ int Kernel::Open(char *filename)
 
 int Kernel::Write(char* buffer , int size , int id)
 {
+    bool writeEnd;
+    Pipe* pipe = FindPipe(id, &writeEnd);
+    if(pipe != NULL) return writeEnd ? pipe->Write(buffer, size) : -1;
+
     OpenFile* file = (OpenFile*) id;
     for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
         if(fileSystem->openFileTable[i] == file)
@@ -378,6 +457,10 @@ int Kernel::Write(char* buffer , int size , int id)
 
 int Kernel::Read(char* buffer , int size , int id)
 {
+    bool writeEnd;
+    Pipe* pipe = FindPipe(id, &writeEnd);
+    if(pipe != NULL) return writeEnd ? -1 : pipe->Read(buffer, size);
+
     OpenFile* file = (OpenFile*) id;
     for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
         if(fileSystem->openFileTable[i] == file)
@@ -387,6 +470,15 @@ int Kernel::Read(char* buffer , int size , int id)
 
 int Kernel::Close(int id)
 {
+    bool writeEnd;
+    Pipe* pipe = FindPipe(id, &writeEnd);
+    if(pipe != NULL)
+    {
+        currentThread->space->PipeEnds()->Remove(id);
+        CloseEnd(pipe, writeEnd);
+        return 1;
+    }
+
     OpenFile* file = (OpenFile*) id;
     for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
     {
@@ -394,9 +486,122 @@ int Kernel::Close(int id)
         {
             fileSystem->openFileTable[i] = fileSystem->openFileTable[fileSystem->openFileTableTop-1];
             fileSystem->openFileTableTop--;
-            delete file;
+            if(!mappedFiles->IsInList(file))   // else its mappings do
+                delete file;
             return 1;
         }
     }
     return 0;
 }
+
+int Kernel::Seek(int position, int id)
+{
+    OpenFile* file = FindFile(id);
+    if(file == NULL || position < 0) return -1;
+    file->Seek(position);
+    return 1;
+}
+
+OpenFile* Kernel::FindFile(int id)
+{
+    OpenFile* file = (OpenFile*) id;
+    for(int i=0 ; i < fileSystem->openFileTableTop ; i++)
+        if(fileSystem->openFileTable[i] == file)
+            return file;
+    return NULL;
+}
+
+// a mapped file stays open until its last mapping goes away, even if
+// the program closes it: its pages must be written back to it, and
+// not to a file opened later at the same address
+void Kernel::HoldFile(OpenFile *file)
+{
+    mappedFiles->Append(file);
+}
+
+void Kernel::ReleaseFile(OpenFile *file)
+{
+    mappedFiles->Remove(file);
+    if(!mappedFiles->IsInList(file) && FindFile((int) file) == NULL)
+        delete file;
+}
+
+int Kernel::NewPipe(int *readId, int *writeId)
+{
+    Pipe* pipe = new Pipe();
+    pipes->Append(pipe);
+    *readId = pipe->ReadId();
+    *writeId = pipe->WriteId();
+    currentThread->space->PipeEnds()->Append(*readId);
+    currentThread->space->PipeEnds()->Append(*writeId);
+    return 0;
+}
+
+// an end the program doesn't hold (or closed) is not found, so it
+// can't be used or closed again
+Pipe* Kernel::FindPipe(int id, bool *writeEnd)
+{
+    AddrSpace *space = currentThread->space;
+
+    if(space == NULL || !space->PipeEnds()->IsInList(id))
+        return NULL;
+    return PipeWithEnd(id, writeEnd);
+}
+
+// when a program starts another, the child holds the ends its parent
+// holds, and has to close them too
+void Kernel::InheritPipes(AddrSpace *parent, AddrSpace *child)
+{
+    ListIterator<int> it(parent->PipeEnds());
+    for( ; !it.IsDone() ; it.Next())
+    {
+        bool writeEnd;
+        Pipe* pipe = PipeWithEnd(it.Item(), &writeEnd);
+        ASSERT(pipe != NULL);
+        pipe->Open(writeEnd);
+        child->PipeEnds()->Append(it.Item());
+    }
+}
+
+// a program that exits closes the ends it still holds, so nobody
+// waits forever for it
+void Kernel::ClosePipes(AddrSpace *space)
+{
+    while(!space->PipeEnds()->IsEmpty())
+    {
+        bool writeEnd;
+        Pipe* pipe = PipeWithEnd(space->PipeEnds()->RemoveFront(), &writeEnd);
+        ASSERT(pipe != NULL);
+        CloseEnd(pipe, writeEnd);
+    }
+}
+
+void Kernel::CloseEnd(Pipe *pipe, bool writeEnd)
+{
+    pipe->Close(writeEnd);
+    if(pipe->IsClosed())
+    {
+        pipes->Remove(pipe);
+        delete pipe;
+    }
+}
+
+Pipe* Kernel::PipeWithEnd(int id, bool *writeEnd)
+{
+    ListIterator<Pipe *> it(pipes);
+    for( ; !it.IsDone() ; it.Next())
+    {
+        Pipe* pipe = it.Item();
+        if(id == pipe->ReadId() && pipe->IsOpen(FALSE))
+        {
+            *writeEnd = FALSE;
+            return pipe;
+        }
+        if(id == pipe->WriteId() && pipe->IsOpen(TRUE))
+        {
+            *writeEnd = TRUE;
+            return pipe;
+        }
+    }
+    return NULL;
+}
@@ -24,7 +24,16 @@ class PostOfficeOutput;
 class SynchConsoleInput;
 class SynchConsoleOutput;
 class SynchDisk;
-
+class FrameTable;
+class InvertedPageTable;
+class SwapSpace;
+class CompressedCache;
+class SyscallTable;
+class SharedMemory;
+class Pipe;
+class ProcessTable;
+class StackPool;
+class OpenFile;
 
 
 class Kernel {
@@ -42,7 +51,7 @@ class Kernel {
 
     void ConsoleTest();         // interactive console self test
     void NetworkTest();         // interactive 2-machine network test
-	Thread* getThread(int threadID){return t[threadID];}
+	int NewThreadID(){return threadNum++;}	// for kernel threads
 
 	int CreateFile(char* filename); // fileSystem call
 
@@ -52,14 +61,49 @@ class Kernel {
     int Write(char* buffer , int size , int id);
     int Read(char* buffer , int size , int id);
     int Close(int id);
+    int Seek(int position, int id);
+    OpenFile *FindFile(int id);	// open file "id", NULL if none
+    void HoldFile(OpenFile *file);
+				// keep "file" open for a mapping, even
+				// once it is closed
+    void ReleaseFile(OpenFile *file);
+				// ... until the mapping goes away
+    int NewPipe(int *readId, int *writeId);
+				// create a pipe, return the ids of its ends
+    Pipe *FindPipe(int id, bool *writeEnd);
+				// pipe with an end "id" the current
+				// program holds, NULL if none
+    void InheritPipes(AddrSpace *parent, AddrSpace *child);
+				// "child" holds the ends "parent" does
+    void ClosePipes(AddrSpace *space);
+				// close every end "space" holds
 
     /* MP2 */
-    List<int> *freeFrameList;
+    FrameTable *frameTable;	// which physical frames are in use
+    InvertedPageTable *invertedTable;
+				// if not NULL, translate all address
+				// spaces through this table instead of
+				// per-process page tables
+    bool largePages;		// map big regions with large pages
+    SwapSpace *swapSpace;	// if not NULL, address spaces are
+				// demand paged from here
+    CompressedCache *compressedCache;
+				// if not NULL, evicted pages are
+				// kept here before going to swap
+    SyscallTable *syscallTable;	// dispatches system calls
+    SharedMemory *sharedMemory;	// segments mapped by several
+				// address spaces
+    List<Pipe *> *pipes;	// pipes with an end open
+    List<OpenFile *> *mappedFiles;
+				// files held by mappings, once for
+				// each mapping
+    ProcessTable *processTable;	// the user programs running
 
 // These are public for notational convenience; really,
 // they're global variables used everywhere.
 
     Thread *currentThread;	// the thread holding the CPU
+    StackPool *stackPool;	// stacks for forked threads
     Scheduler *scheduler;	// the ready list
     Interrupt *interrupt;	// interrupt status
     Statistics *stats;		// performance metrics
@@ -75,18 +119,26 @@ class Kernel {
     int hostName;               // machine identifier
 
   private:
-
-	Thread* t[10];
-	char*   execfile[10];
+    Pipe *PipeWithEnd(int id, bool *writeEnd);
+				// pipe with an open end "id", held
+				// by anyone
+    void CloseEnd(Pipe *pipe, bool writeEnd);
+				// let go of an end, and delete the
+				// pipe once both are closed
+
+	char**  execfile;	// programs to run, from -e and -ep
 	int execfileNum;
 
     /* MP3 */
-    int execpriority[10];
-    int execpriorityNum;
+    int* execpriority;
 
 	int threadNum;
     bool randomSlice;		// enable pseudo-random time slicing
     bool debugUserProg;         // single step user program
+    bool useInvertedTable;	// use one inverted page table
+    bool demandPaging;		// page user programs in on demand
+    bool compressSwap;		// compress evicted pages in memory
+    char *schedPolicy;		// which ready thread runs next
     double reliability;         // likelihood messages are dropped
     char *consoleIn;            // file to read console input from
     char *consoleOut;           // file to send console output to
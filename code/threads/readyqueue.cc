@@ -0,0 +1,787 @@
+// readyqueue.cc
+//	Routines to manage the ready queues of the multilevel scheduler.
+//
+//	Like the rest of the scheduler, these assume interrupts are
+//	disabled.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "readyqueue.h"
+#include "thread.h"
+
+//----------------------------------------------------------------------
+// PriorityQueue::PriorityQueue
+// 	Initialize an empty queue, for threads with priorities from
+//	"low" to "high".
+//----------------------------------------------------------------------
+
+PriorityQueue::PriorityQueue(int low, int high)
+{
+    lowest = low;
+    numPriorities = high - low + 1;
+    queue = new List<Thread *> *[numPriorities];
+    for (int i = 0; i < numPriorities; i++) {
+	queue[i] = new List<Thread *>;
+    }
+    nonEmpty = new Bitmap(numPriorities);
+    numInQueue = 0;
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue::~PriorityQueue
+// 	De-allocate the queue.  The threads in it are not ours.
+//----------------------------------------------------------------------
+
+PriorityQueue::~PriorityQueue()
+{
+    for (int i = 0; i < numPriorities; i++) {
+	delete queue[i];
+    }
+    delete [] queue;
+    delete nonEmpty;
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue::Append
+// 	Put "thread" at the end of the FIFO for its priority.
+//----------------------------------------------------------------------
+
+void
+PriorityQueue::Append(Thread *thread)
+{
+    int i = thread->getPriority() - lowest;
+
+    ASSERT(i >= 0 && i < numPriorities);
+    queue[i]->Append(thread);
+    nonEmpty->Mark(i);
+    numInQueue++;
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue::Remove
+// 	Take "thread" out of the queue, wherever it is in its FIFO.  Its
+//	priority may have changed since it was appended, at "priority".
+//----------------------------------------------------------------------
+
+void
+PriorityQueue::Remove(Thread *thread, int priority)
+{
+    int i = priority - lowest;
+
+    ASSERT(i >= 0 && i < numPriorities);
+    queue[i]->Remove(thread);
+    if (queue[i]->IsEmpty()) {
+	nonEmpty->Clear(i);
+    }
+    numInQueue--;
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue::Front
+// 	Return the thread that has waited longest among those with the
+//	highest priority, without taking it out; NULL if there is none.
+//----------------------------------------------------------------------
+
+Thread *
+PriorityQueue::Front()
+{
+    int i = nonEmpty->FindLast();
+
+    if (i == -1) {
+	return NULL;
+    }
+    return queue[i]->Front();
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue::RemoveFront
+// 	Take out, and return, the thread Front would return.
+//----------------------------------------------------------------------
+
+Thread *
+PriorityQueue::RemoveFront()
+{
+    int i = nonEmpty->FindLast();
+    Thread *thread;
+
+    if (i == -1) {
+	return NULL;
+    }
+    thread = queue[i]->RemoveFront();
+    if (queue[i]->IsEmpty()) {
+	nonEmpty->Clear(i);
+    }
+    numInQueue--;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// PriorityQueue::Apply
+// 	Call "func" on every thread in the queue, in the order they
+//	would be taken out.
+//----------------------------------------------------------------------
+
+void
+PriorityQueue::Apply(void (*func)(Thread *))
+{
+    for (int i = numPriorities - 1; i >= 0; i--) {
+	queue[i]->Apply(func);
+    }
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::BurstQueue
+// 	Initialize an empty queue.  The heap grows as needed.
+//----------------------------------------------------------------------
+
+BurstQueue::BurstQueue()
+{
+    heapSize = 16;
+    heap = new BurstEntry[heapSize];
+    numInQueue = 0;
+    numInserted = 0;
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::~BurstQueue
+// 	De-allocate the queue.  The threads in it are not ours.
+//----------------------------------------------------------------------
+
+BurstQueue::~BurstQueue()
+{
+    delete [] heap;
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::Before
+// 	Return TRUE if entry "i" of the heap must be taken out before
+//	entry "j": its burst time is shorter, or it is as long (in whole
+//	ticks) and it was inserted first.
+//----------------------------------------------------------------------
+
+bool
+BurstQueue::Before(int i, int j)
+{
+    if (heap[i].burst != heap[j].burst) {
+	return heap[i].burst < heap[j].burst;
+    }
+    return (int) (heap[i].order - heap[j].order) < 0;
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::Swap
+// 	Exchange entries "i" and "j" of the heap.
+//----------------------------------------------------------------------
+
+void
+BurstQueue::Swap(int i, int j)
+{
+    BurstEntry tmp = heap[i];
+
+    heap[i] = heap[j];
+    heap[j] = tmp;
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::Insert
+// 	Put "thread" in the queue, ordered by its burst time as it is
+//	now.  If the heap is full, double it.
+//----------------------------------------------------------------------
+
+void
+BurstQueue::Insert(Thread *thread)
+{
+    int i = numInQueue;
+
+    if (numInQueue == heapSize) {
+	BurstEntry *bigger = new BurstEntry[2 * heapSize];
+
+	for (int j = 0; j < heapSize; j++) {
+	    bigger[j] = heap[j];
+	}
+	delete [] heap;
+	heap = bigger;
+	heapSize *= 2;
+    }
+    heap[i].thread = thread;
+    heap[i].burst = (int) thread->getBurstTime();
+    heap[i].order = numInserted++;
+    numInQueue++;
+
+    while (i > 0 && Before(i, (i - 1) / 2)) {	// sift up
+	Swap(i, (i - 1) / 2);
+	i = (i - 1) / 2;
+    }
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::Front
+// 	Return the thread with the shortest burst time, without taking
+//	it out; NULL if there is none.
+//----------------------------------------------------------------------
+
+Thread *
+BurstQueue::Front()
+{
+    return (numInQueue == 0) ? NULL : heap[0].thread;
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::RemoveFront
+// 	Take out, and return, the thread Front would return.
+//----------------------------------------------------------------------
+
+Thread *
+BurstQueue::RemoveFront()
+{
+    Thread *thread;
+    int i = 0;
+
+    if (numInQueue == 0) {
+	return NULL;
+    }
+    thread = heap[0].thread;
+    heap[0] = heap[--numInQueue];
+
+    for (;;) {					// sift down
+	int child = 2 * i + 1;
+
+	if (child >= numInQueue) {
+	    break;
+	}
+	if (child + 1 < numInQueue && Before(child + 1, child)) {
+	    child++;
+	}
+	if (!Before(child, i)) {
+	    break;
+	}
+	Swap(i, child);
+	i = child;
+    }
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// BurstQueue::Apply
+// 	Call "func" on every thread in the queue, in the order they
+//	would be taken out.  Takes them out of a copy of the heap, so
+//	"func" must not change the queue.
+//----------------------------------------------------------------------
+
+void
+BurstQueue::Apply(void (*func)(Thread *))
+{
+    BurstEntry *saved = heap;
+    int numSaved = numInQueue;
+
+    heap = new BurstEntry[heapSize];
+    for (int i = 0; i < numSaved; i++) {
+	heap[i] = saved[i];
+    }
+    while (numInQueue > 0) {
+	(*func)(RemoveFront());
+    }
+    delete [] heap;
+    heap = saved;
+    numInQueue = numSaved;
+}
+
+//----------------------------------------------------------------------
+// AgingQueue::AgingQueue
+// 	Initialize an empty queue.
+//----------------------------------------------------------------------
+
+AgingQueue::AgingQueue()
+{
+    first = last = NULL;
+}
+
+//----------------------------------------------------------------------
+// AgingQueue::Append
+// 	Put "thread" at the end of the queue.  It must not be in it.
+//----------------------------------------------------------------------
+
+void
+AgingQueue::Append(Thread *thread)
+{
+    ASSERT(thread->agingPrev == NULL && thread != first);
+    thread->agingPrev = last;
+    thread->agingNext = NULL;
+    if (last == NULL) {
+	first = thread;
+    } else {
+	last->agingNext = thread;
+    }
+    last = thread;
+}
+
+//----------------------------------------------------------------------
+// AgingQueue::Remove
+// 	Take "thread" out of the queue, wherever it is.
+//----------------------------------------------------------------------
+
+void
+AgingQueue::Remove(Thread *thread)
+{
+    if (thread->agingPrev == NULL) {
+	ASSERT(first == thread);
+	first = thread->agingNext;
+    } else {
+	thread->agingPrev->agingNext = thread->agingNext;
+    }
+    if (thread->agingNext == NULL) {
+	last = thread->agingPrev;
+    } else {
+	thread->agingNext->agingPrev = thread->agingPrev;
+    }
+    thread->agingPrev = thread->agingNext = NULL;
+}
+
+//----------------------------------------------------------------------
+// AgingQueue::Next
+// 	Return the thread behind "thread" in the queue, NULL if it is
+//	the last.
+//----------------------------------------------------------------------
+
+Thread *
+AgingQueue::Next(Thread *thread)
+{
+    return thread->agingNext;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::FairQueue
+// 	Initialize an empty tree.  Its leaves are all the same black
+//	sentinel node, so the balancing code needn't check for NULL.
+//----------------------------------------------------------------------
+
+FairQueue::FairQueue()
+{
+    nil = new FairNode;
+    nil->thread = NULL;
+    nil->red = FALSE;
+    nil->left = nil->right = nil->parent = nil;
+    root = leftmost = nil;
+    numInQueue = 0;
+    numInserted = 0;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::~FairQueue
+// 	De-allocate the sentinel.  The nodes are in the threads, which
+//	are not ours.
+//----------------------------------------------------------------------
+
+FairQueue::~FairQueue()
+{
+    delete nil;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::Before
+// 	Return TRUE if the thread of node "a" must run before that of
+//	"b": its key is smaller, or the same and it was inserted first.
+//----------------------------------------------------------------------
+
+bool
+FairQueue::Before(FairNode *a, FairNode *b)
+{
+    if (a->key != b->key) {
+	return a->key < b->key;
+    }
+    return (int) (a->order - b->order) < 0;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::RotateLeft
+// 	Make the right child of "x" its parent, keeping the order.
+//----------------------------------------------------------------------
+
+void
+FairQueue::RotateLeft(FairNode *x)
+{
+    FairNode *y = x->right;
+
+    x->right = y->left;
+    if (y->left != nil) {
+	y->left->parent = x;
+    }
+    Replace(x, y);
+    y->left = x;
+    x->parent = y;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::RotateRight
+// 	Make the left child of "x" its parent, keeping the order.
+//----------------------------------------------------------------------
+
+void
+FairQueue::RotateRight(FairNode *x)
+{
+    FairNode *y = x->left;
+
+    x->left = y->right;
+    if (y->right != nil) {
+	y->right->parent = x;
+    }
+    Replace(x, y);
+    y->right = x;
+    x->parent = y;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::Replace
+// 	Make "node" the child of the parent of "old", in its place.
+//	"node" may be the sentinel; its parent is then set anyway, for
+//	RemoveFixup.
+//----------------------------------------------------------------------
+
+void
+FairQueue::Replace(FairNode *old, FairNode *node)
+{
+    if (old->parent == nil) {
+	root = node;
+    } else if (old == old->parent->left) {
+	old->parent->left = node;
+    } else {
+	old->parent->right = node;
+    }
+    node->parent = old->parent;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::Insert
+// 	Put "thread" in the tree, with key "key".  If it went left all
+//	the way down, it is the new leftmost node.  Its node is the one
+//	in the thread, so it must not be in a FairQueue already.
+//----------------------------------------------------------------------
+
+void
+FairQueue::Insert(Thread *thread, double key)
+{
+    FairNode *node = &thread->fairNode;
+    FairNode *parent = nil;
+    FairNode *x = root;
+    bool isLeftmost = TRUE;
+
+    node->thread = thread;
+    node->key = key;
+    node->order = numInserted++;
+    node->left = node->right = nil;
+    node->red = TRUE;
+
+    while (x != nil) {
+	parent = x;
+	if (Before(node, x)) {
+	    x = x->left;
+	} else {
+	    x = x->right;
+	    isLeftmost = FALSE;
+	}
+    }
+    node->parent = parent;
+    if (parent == nil) {
+	root = node;
+    } else if (Before(node, parent)) {
+	parent->left = node;
+    } else {
+	parent->right = node;
+    }
+    if (isLeftmost) {
+	leftmost = node;
+    }
+    numInQueue++;
+    InsertFixup(node);
+}
+
+//----------------------------------------------------------------------
+// FairQueue::InsertFixup
+// 	Red "node" was just inserted: restore the red-black properties.
+//	No red node may have a red child, and every path from the root
+//	to a leaf must have as many black nodes.
+//----------------------------------------------------------------------
+
+void
+FairQueue::InsertFixup(FairNode *node)
+{
+    while (node->parent->red) {
+	FairNode *grandparent = node->parent->parent;
+
+	if (node->parent == grandparent->left) {
+	    FairNode *uncle = grandparent->right;
+
+	    if (uncle->red) {			// recolor, and go up
+		node->parent->red = FALSE;
+		uncle->red = FALSE;
+		grandparent->red = TRUE;
+		node = grandparent;
+	    } else {				// rotate, and done
+		if (node == node->parent->right) {
+		    node = node->parent;
+		    RotateLeft(node);
+		}
+		node->parent->red = FALSE;
+		grandparent->red = TRUE;
+		RotateRight(grandparent);
+	    }
+	} else {				// the same, mirrored
+	    FairNode *uncle = grandparent->left;
+
+	    if (uncle->red) {
+		node->parent->red = FALSE;
+		uncle->red = FALSE;
+		grandparent->red = TRUE;
+		node = grandparent;
+	    } else {
+		if (node == node->parent->left) {
+		    node = node->parent;
+		    RotateRight(node);
+		}
+		node->parent->red = FALSE;
+		grandparent->red = TRUE;
+		RotateLeft(grandparent);
+	    }
+	}
+    }
+    root->red = FALSE;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::Front
+// 	Return the thread with the smallest key, without taking it out;
+//	NULL if there is none.
+//----------------------------------------------------------------------
+
+Thread *
+FairQueue::Front()
+{
+    return leftmost->thread;		// NULL for the sentinel
+}
+
+//----------------------------------------------------------------------
+// FairQueue::RemoveFront
+// 	Take out, and return, the thread Front would return.  The
+//	leftmost node has no left child, so its right child just takes
+//	its place; its successor is the leftmost node of that subtree,
+//	or else its parent.
+//----------------------------------------------------------------------
+
+Thread *
+FairQueue::RemoveFront()
+{
+    FairNode *node = leftmost;
+    FairNode *child = node->right;
+    Thread *thread = node->thread;
+
+    if (node == nil) {
+	return NULL;
+    }
+    if (child != nil) {
+	for (leftmost = child; leftmost->left != nil; )
+	    leftmost = leftmost->left;
+    } else {
+	leftmost = node->parent;
+    }
+    Replace(node, child);
+    if (!node->red) {
+	RemoveFixup(child);
+    }
+    numInQueue--;
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::RemoveFixup
+// 	A black node was removed above "node": it has one black node too
+//	few on its paths.  Restore the red-black properties.
+//----------------------------------------------------------------------
+
+void
+FairQueue::RemoveFixup(FairNode *node)
+{
+    while (node != root && !node->red) {
+	FairNode *parent = node->parent;
+
+	if (node == parent->left) {
+	    FairNode *sibling = parent->right;
+
+	    if (sibling->red) {
+		sibling->red = FALSE;
+		parent->red = TRUE;
+		RotateLeft(parent);
+		sibling = parent->right;
+	    }
+	    if (!sibling->left->red && !sibling->right->red) {
+		sibling->red = TRUE;
+		node = parent;
+	    } else {
+		if (!sibling->right->red) {
+		    sibling->left->red = FALSE;
+		    sibling->red = TRUE;
+		    RotateRight(sibling);
+		    sibling = parent->right;
+		}
+		sibling->red = parent->red;
+		parent->red = FALSE;
+		sibling->right->red = FALSE;
+		RotateLeft(parent);
+		node = root;
+	    }
+	} else {				// the same, mirrored
+	    FairNode *sibling = parent->left;
+
+	    if (sibling->red) {
+		sibling->red = FALSE;
+		parent->red = TRUE;
+		RotateRight(parent);
+		sibling = parent->left;
+	    }
+	    if (!sibling->right->red && !sibling->left->red) {
+		sibling->red = TRUE;
+		node = parent;
+	    } else {
+		if (!sibling->left->red) {
+		    sibling->right->red = FALSE;
+		    sibling->red = TRUE;
+		    RotateLeft(sibling);
+		    sibling = parent->left;
+		}
+		sibling->red = parent->red;
+		parent->red = FALSE;
+		sibling->left->red = FALSE;
+		RotateRight(parent);
+		node = root;
+	    }
+	}
+    }
+    node->red = FALSE;
+}
+
+//----------------------------------------------------------------------
+// FairQueue::Apply
+// 	Call "func" on every thread in the queue, smallest key first.
+//----------------------------------------------------------------------
+
+void
+FairQueue::Apply(void (*func)(Thread *))
+{
+    ApplyTree(root, func);
+}
+
+void
+FairQueue::ApplyTree(FairNode *node, void (*func)(Thread *))
+{
+    if (node == nil) {
+	return;
+    }
+    ApplyTree(node->left, func);
+    (*func)(node->thread);
+    ApplyTree(node->right, func);
+}
+
+//----------------------------------------------------------------------
+// FairQueue::Check
+// 	ASSERT that the tree is a red-black tree, in order, with the
+//	right leftmost node and count.
+//----------------------------------------------------------------------
+
+void
+FairQueue::Check()
+{
+    FairNode *prev = NULL;
+    int count = 0;
+
+    ASSERT(!nil->red && !root->red);
+    ASSERT(root == nil || root->parent == nil);
+    CheckTree(root, &prev, &count);
+    ASSERT(count == numInQueue);
+    ASSERT(numInQueue > 0 || leftmost == nil);
+}
+
+//----------------------------------------------------------------------
+// FairQueue::CheckTree
+// 	Check the subtree below "node", in order: "prev" is the node
+//	before it, NULL if none, and "count" the number of nodes so
+//	far.  Return its black height.
+//----------------------------------------------------------------------
+
+int
+FairQueue::CheckTree(FairNode *node, FairNode **prev, int *count)
+{
+    int height;
+
+    if (node == nil) {
+	return 1;
+    }
+    ASSERT(node->left == nil || node->left->parent == node);
+    ASSERT(node->right == nil || node->right->parent == node);
+    ASSERT(!node->red || (!node->left->red && !node->right->red));
+
+    height = CheckTree(node->left, prev, count);
+    if (*prev == NULL) {
+	ASSERT(node == leftmost);
+    } else {
+	ASSERT(Before(*prev, node));
+    }
+    *prev = node;
+    (*count)++;
+    ASSERT(CheckTree(node->right, prev, count) == height);
+    return height + (node->red ? 0 : 1);
+}
+
+//----------------------------------------------------------------------
+// FairQueue::SelfTest
+// 	Test whether this module is working.  Insert threads with keys
+//	in random order, many of them equal, take out half and put them
+//	back with new keys, then take them all out: they must come out
+//	in order, and the tree must stay a red-black tree throughout.
+//----------------------------------------------------------------------
+
+static char fairTestName[] = "fair test";
+static const int NumFairTest = 200;
+
+void
+FairQueue::SelfTest()
+{
+    Thread *threads[NumFairTest];
+    FairNode *prev;
+    int i;
+
+    ASSERT(IsEmpty());
+    for (i = 0; i < NumFairTest; i++) {
+	threads[i] = new Thread(fairTestName, i);
+	Insert(threads[i], RandomNumber() % 50);
+	Check();
+    }
+    ASSERT(NumInQueue() == NumFairTest);
+
+    prev = NULL;			// take out half...
+    for (i = 0; i < NumFairTest / 2; i++) {
+	threads[i] = RemoveFront();
+	ASSERT(prev == NULL || Before(prev, &threads[i]->fairNode));
+	prev = &threads[i]->fairNode;
+	Check();
+    }
+    for (i = 0; i < NumFairTest / 2; i++) {	// ... and put them back
+	Insert(threads[i], RandomNumber() % 50);
+	Check();
+    }
+
+    prev = NULL;
+    for (i = 0; i < NumFairTest; i++) {
+	threads[i] = RemoveFront();
+	ASSERT(threads[i] != NULL);
+	ASSERT(prev == NULL || Before(prev, &threads[i]->fairNode));
+	prev = &threads[i]->fairNode;
+	Check();
+    }
+    ASSERT(IsEmpty() && Front() == NULL && RemoveFront() == NULL);
+
+    for (i = 0; i < NumFairTest; i++) {
+	delete threads[i];
+    }
+}
@@ -0,0 +1,176 @@
+// readyqueue.h
+//	Data structures for the ready queues of the multilevel scheduler.
+//
+//	Queue L2 orders threads by priority, and L1 by approximate burst
+//	time.  Kept as sorted lists, every insertion walked the queue;
+//	with many ready threads each scheduling decision got slower.
+//
+//	A PriorityQueue keeps one FIFO per priority, and a bitmap of
+//	which are not empty: inserting is an append, and the highest
+//	priority is found a word of the bitmap at a time.  A BurstQueue
+//	is a binary heap on the burst time, so its operations take
+//	logarithmic time.  Both keep threads that compare equal in the
+//	order they were inserted, like SortedList does.
+//
+//	An AgingQueue keeps every ready thread in the order it started
+//	waiting, so the threads that have waited longest, the only ones
+//	that may need aging, are at the front.  The links are in the
+//	threads themselves: nothing is allocated to queue a thread.
+//
+//	A FairQueue, for the fair scheduler, orders threads by the CPU
+//	time they have had (see FairPolicy).  It is a red-black tree, so
+//	it stays balanced whatever order threads come in, and it keeps
+//	its leftmost node: the next thread is found in constant time.
+//	Its nodes are in the threads too, so a thread is in at most one
+//	FairQueue at a time.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef READYQUEUE_H
+#define READYQUEUE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "bitmap.h"
+
+class Thread;
+
+// The following class keeps ready threads with priorities from "low"
+// to "high", highest priority first.
+
+class PriorityQueue {
+  public:
+    PriorityQueue(int low, int high);	// Priorities in [low, high]
+    ~PriorityQueue();
+
+    void Append(Thread *thread);	// Put "thread" behind the threads
+					// of its priority
+    void Remove(Thread *thread, int priority);
+					// Take "thread" out; it was
+					// appended at "priority"
+    Thread *Front();			// First thread of the highest
+					// priority, NULL if empty
+    Thread *RemoveFront();		// ... and take it out
+    bool IsEmpty() { return numInQueue == 0; }
+    int NumInQueue() { return numInQueue; }
+    void Apply(void (*func)(Thread *));	// Call "func" on each thread,
+					// highest priority first
+
+  private:
+    int lowest;				// priority of queue[0]
+    int numPriorities;
+    List<Thread *> **queue;		// one FIFO per priority
+    Bitmap *nonEmpty;			// which FIFOs have threads
+    int numInQueue;
+};
+
+// One thread in a BurstQueue, with what it is ordered by.
+
+class BurstEntry {
+  public:
+    Thread *thread;
+    int burst;				// burst time when inserted
+    unsigned int order;			// when inserted, to break ties
+};
+
+// The following class keeps ready threads, shortest burst time first.
+
+class BurstQueue {
+  public:
+    BurstQueue();
+    ~BurstQueue();
+
+    void Insert(Thread *thread);	// Put "thread" in the queue
+    Thread *Front();			// Thread with the shortest burst
+					// time, NULL if empty
+    Thread *RemoveFront();		// ... and take it out
+    bool IsEmpty() { return numInQueue == 0; }
+    int NumInQueue() { return numInQueue; }
+    void Apply(void (*func)(Thread *));	// Call "func" on each thread,
+					// shortest burst time first
+
+  private:
+    bool Before(int i, int j);		// Must entry i run before j?
+    void Swap(int i, int j);
+
+    BurstEntry *heap;			// heap[0] runs first
+    int heapSize;			// # of entries allocated
+    int numInQueue;
+    unsigned int numInserted;		// to number insertions
+};
+
+// One thread in a FairQueue: a node of the red-black tree.  Each
+// Thread has one.
+
+class FairNode {
+  public:
+    Thread *thread;
+    double key;				// virtual runtime when inserted
+    unsigned int order;			// when inserted, to break ties
+    bool red;
+    FairNode *left;
+    FairNode *right;
+    FairNode *parent;
+};
+
+// The following class keeps ready threads, smallest key first.
+
+class FairQueue {
+  public:
+    FairQueue();
+    ~FairQueue();
+
+    void Insert(Thread *thread, double key);
+					// Put "thread" in the queue
+    Thread *Front();			// Thread with the smallest key,
+					// NULL if empty
+    Thread *RemoveFront();		// ... and take it out
+    bool IsEmpty() { return numInQueue == 0; }
+    int NumInQueue() { return numInQueue; }
+    void Apply(void (*func)(Thread *));	// Call "func" on each thread,
+					// smallest key first
+
+    void SelfTest();			// Test whether the tree is working
+
+  private:
+    bool Before(FairNode *a, FairNode *b);
+					// Must "a" run before "b"?
+    void RotateLeft(FairNode *x);
+    void RotateRight(FairNode *x);
+    void InsertFixup(FairNode *node);	// Rebalance after an insertion
+    void RemoveFixup(FairNode *node);	// ... and after a removal
+    void Replace(FairNode *old, FairNode *node);
+					// Put "node" where "old" is
+    void ApplyTree(FairNode *node, void (*func)(Thread *));
+    void Check();			// ASSERT the red-black properties
+    int CheckTree(FairNode *node, FairNode **prev, int *count);
+
+    FairNode *nil;			// the leaves: a black sentinel
+    FairNode *root;
+    FairNode *leftmost;			// nil if the queue is empty
+    int numInQueue;
+    unsigned int numInserted;		// to number insertions
+};
+
+// The following class keeps ready threads in the order they started
+// to wait; they must be appended in that order.
+
+class AgingQueue {
+  public:
+    AgingQueue();
+
+    void Append(Thread *thread);	// "thread" has just started waiting
+    void Remove(Thread *thread);	// Take "thread" out
+    Thread *Front() { return first; }	// Thread waiting longest, NULL if
+					// empty
+    Thread *Next(Thread *thread);	// Thread behind "thread", NULL if
+					// none
+
+  private:
+    Thread *first;
+    Thread *last;
+};
+
+#endif // READYQUEUE_H
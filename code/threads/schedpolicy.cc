@@ -0,0 +1,1097 @@
+// schedpolicy.cc
+//	Routines to keep ready threads, and choose the next to run, for
+//	each scheduling policy.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "schedpolicy.h"
+#include "main.h"
+#include <iostream>
+
+using namespace std;
+
+//----------------------------------------------------------------------
+// NewSchedulingPolicy
+// 	Return a new policy of the kind called "name", or NULL if there
+//	is no such kind.
+//----------------------------------------------------------------------
+
+SchedulingPolicy *
+NewSchedulingPolicy(char *name)
+{
+    if (strcmp(name, "mlfq") == 0) {
+	return new MultilevelPolicy;
+    } else if (strcmp(name, "rr") == 0) {
+	return new FifoPolicy(TRUE);
+    } else if (strcmp(name, "fifo") == 0) {
+	return new FifoPolicy(FALSE);
+    } else if (strcmp(name, "sjf") == 0) {
+	return new ShortestJobPolicy;
+    } else if (strcmp(name, "cfs") == 0) {
+	return new FairPolicy;
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// ShorterThanCurrent
+// 	Return TRUE if ready thread "thread" is expected to run for less
+//	time than the current thread has left, by their burst times.
+//----------------------------------------------------------------------
+
+static bool
+ShorterThanCurrent(Thread *thread)
+{
+    Thread *current = kernel->currentThread;
+
+    if (current->getID() == thread->getID())
+	return FALSE;
+    double actBurst = kernel->stats->userTicks - current->getStartTime();
+    double estBurst = 0.5 * actBurst + 0.5 * current->getBurstTime();
+    return thread->getBurstTime() < estBurst;
+}
+
+//----------------------------------------------------------------------
+// EstimateBurst
+// 	"thread" is giving up the CPU: estimate its next burst from the
+//	one just ended, and those before.
+//----------------------------------------------------------------------
+
+static void
+EstimateBurst(Thread *thread)
+{
+    double actBurst = kernel->stats->userTicks - thread->getStartTime();
+    double estBurst = 0.5 * actBurst + 0.5 * thread->getBurstTime();
+    thread->setBurstTime(estBurst);
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::MultilevelPolicy
+// 	Initialize the three queues, empty.
+//----------------------------------------------------------------------
+
+MultilevelPolicy::MultilevelPolicy()
+{
+    /* MP3 Init Queue */
+    L1Queue = new BurstQueue;
+    L2Queue = new PriorityQueue(50, 99);
+    L3Queue = new List<Thread *>;
+    agingQueue = new AgingQueue;
+    numQueued = 0;
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::~MultilevelPolicy
+// 	De-allocate the queues.
+//----------------------------------------------------------------------
+
+MultilevelPolicy::~MultilevelPolicy()
+{
+    delete L1Queue;
+    delete L2Queue;
+    delete L3Queue;
+    delete agingQueue;
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::Insert
+// 	Put "thread" in the queue for its priority: 100-149 in L1, 50-99
+//	in L2, and the rest in L3.
+//----------------------------------------------------------------------
+
+void
+MultilevelPolicy::Insert(Thread *thread)
+{
+    /* MP3 into queue */
+    int p = thread->getPriority();
+    int nowTime = kernel->stats->totalTicks;
+    cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L";
+    thread->setReadyOrder(numQueued++);
+    if(100 <=  p && p <= 149)
+	{
+        L1Queue->Insert(thread);
+        cout << 1 << endl;
+    }
+	else if(50 <= p && p <= 99)
+    {
+		L2Queue->Append(thread);
+        cout << 2 << endl;
+    }
+	else
+    {
+     L3Queue->Append(thread);
+     cout << 3 << endl;
+    }
+
+    /* MP3 Aging , now thread starts to wait */
+    thread->setStartWaitTime(nowTime);
+    agingQueue->Append(thread);
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::RemoveNext
+// 	Take out the first thread of the first queue that has one.
+//----------------------------------------------------------------------
+
+Thread *
+MultilevelPolicy::RemoveNext()
+{
+    /* MP3 Which is Next ? */
+    int nowTime = kernel->stats->totalTicks;
+    Thread *thread;
+    if(!L1Queue->IsEmpty())
+    {
+        cout << "Tick " << nowTime << ": Thread " << L1Queue->Front()->getID() << " is removed from queue L";
+        cout << 1 << endl;
+
+        thread = L1Queue->RemoveFront();
+    }
+    else if(!L2Queue->IsEmpty())
+    {
+        cout << "Tick " << nowTime << ": Thread " << L2Queue->Front()->getID() << " is removed from queue L";
+        cout << 2 << endl;
+
+        thread = L2Queue->RemoveFront();
+    }
+    else if (!L3Queue->IsEmpty())
+    {
+        cout << "Tick " << nowTime << ": Thread " << L3Queue->Front()->getID() << " is removed from queue L";
+        cout << 3 << endl;
+
+        thread = L3Queue->RemoveFront();
+    }
+    else
+        return NULL;
+
+    /* MP3 no longer waiting */
+    agingQueue->Remove(thread);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::Preempts
+// 	L1 is preemptive: a thread put in it preempts a running L1
+//	thread, if it is expected to be shorter.
+//----------------------------------------------------------------------
+
+bool
+MultilevelPolicy::Preempts(Thread *thread)
+{
+    int p = kernel->currentThread->getPriority();
+
+    /* MP3 preemptive , only SJF */
+    return 100 <= thread->getPriority() && thread->getPriority() <= 149
+		&& 100 <= p && p <= 149 && ShorterThanCurrent(thread);
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::TimeSliced
+// 	Only L3 is round robin.
+//----------------------------------------------------------------------
+
+bool
+MultilevelPolicy::TimeSliced(Thread *thread)
+{
+    /* MP3 if currentThread is RR and time to switch */
+    return thread->getPriority() <= 49;
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::Stopped
+// 	Estimate the next burst of an L1 thread.
+//----------------------------------------------------------------------
+
+void
+MultilevelPolicy::Stopped(Thread *thread)
+{
+    /* SJF */
+    if(thread->getPriority() >= 100)
+	EstimateBurst(thread);
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::CheckAging
+// 	If ready thread "thread" has waited 1500 ticks, raise its
+//	priority by 10, and move it up a queue if that takes it there.
+//	Return TRUE if it moved to L1.
+//----------------------------------------------------------------------
+
+bool
+MultilevelPolicy::CheckAging(Thread *thread)
+{
+    int nowTime = kernel->stats->totalTicks;
+    /* In ready queue and wait time >= 1500 */
+    if(thread->getStatus() == READY && nowTime - thread->getStartWaitTime() >= 1500)
+    {
+        /* Aging */
+        int oldPriority = thread->getPriority();
+        int newPriority = (oldPriority + 10 > 149) ? 149 : oldPriority + 10;
+        thread->setPriority(newPriority);
+        if(oldPriority != newPriority){
+          cout << "Tick " << nowTime << ": Thread " << thread->getID();
+          cout << " changes its priority from " << oldPriority << " to " << newPriority << endl;
+        }
+
+        if(newPriority >= 100 && newPriority < 110) /* L2 -> L1 */
+        {
+            L2Queue->Remove(thread, oldPriority);
+            thread->setReadyOrder(numQueued++);
+            L1Queue->Insert(thread);
+            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is removed from queue L2" << endl;
+            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L1"<< endl;
+
+            /* Reset wait time, before it may run */
+            ResetWait(thread);
+
+            /* Preemptive , Only SJF */
+            if(Preempts(thread))
+                kernel->currentThread->Yield();
+            return TRUE;
+        }
+        else if(newPriority >= 50 && newPriority < 60) /* L3 -> L2 */
+        {
+            L3Queue->Remove(thread);
+            thread->setReadyOrder(numQueued++);
+            L2Queue->Append(thread);
+            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is removed from queue L3" << endl;
+            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L2" << endl;
+        }
+        else if(oldPriority >= 50 && oldPriority < 100) /* within L2 */
+        {
+            L2Queue->Remove(thread, oldPriority);
+            thread->setReadyOrder(numQueued++);
+            L2Queue->Append(thread);
+        }
+        /* Reset wait time */
+        ResetWait(thread);
+    }
+    return FALSE;
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::ResetWait
+// 	Ready thread "thread" starts waiting again, now.
+//----------------------------------------------------------------------
+
+void
+MultilevelPolicy::ResetWait(Thread *thread)
+{
+    agingQueue->Remove(thread);
+    thread->setStartWaitTime(kernel->stats->totalTicks);
+    agingQueue->Append(thread);
+}
+
+//----------------------------------------------------------------------
+// AgesBefore
+// 	Return TRUE if ready thread "a" is aged before "b", when both
+//	are due in the same tick: threads are aged in queue order, L1
+//	then L2 then L3.
+//----------------------------------------------------------------------
+
+static int
+QueueLevel(Thread *thread)
+{
+    int p = thread->getPriority();
+
+    return (p >= 100) ? 1 : (p >= 50) ? 2 : 3;
+}
+
+static bool
+AgesBefore(Thread *a, Thread *b)
+{
+    int level = QueueLevel(a);
+
+    if (level != QueueLevel(b)) {
+        return level < QueueLevel(b);
+    }
+    if (level == 1 && (int) a->getBurstTime() != (int) b->getBurstTime()) {
+        return (int) a->getBurstTime() < (int) b->getBurstTime();
+    }
+    if (level == 2 && a->getPriority() != b->getPriority()) {
+        return a->getPriority() > b->getPriority();
+    }
+    return (int) (a->getReadyOrder() - b->getReadyOrder()) < 0;
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::Tick
+// 	Age every thread that has been ready for too long.  Ready
+//	threads are in the aging queue in the order they started
+//	waiting, so only the ones due are looked at, and aging a thread
+//	moves it to the back.
+//
+//	The threads due are aged one at a time, in queue order, looking
+//	for the next after each: aging one may preempt the current
+//	thread, and the others may run (or even finish) meanwhile.
+//----------------------------------------------------------------------
+
+void
+MultilevelPolicy::Tick()
+{
+    int nowTime = kernel->stats->totalTicks;
+
+    for (;;) {
+        Thread *next = NULL;
+
+        for (Thread *t = agingQueue->Front();
+             t != NULL && nowTime - t->getStartWaitTime() >= 1500;
+             t = agingQueue->Next(t)) {
+            if (next == NULL || AgesBefore(t, next))
+                next = t;
+        }
+        if (next == NULL)
+            return;
+        CheckAging(next);
+        nowTime = kernel->stats->totalTicks;
+    }
+}
+
+//----------------------------------------------------------------------
+// MultilevelPolicy::Apply
+// 	Call "func" on every ready thread, L1 first.
+//----------------------------------------------------------------------
+
+void
+MultilevelPolicy::Apply(void (*func)(Thread *))
+{
+    L1Queue->Apply(func);
+    L2Queue->Apply(func);
+    L3Queue->Apply(func);
+}
+
+//----------------------------------------------------------------------
+// FifoPolicy::FifoPolicy
+// 	Initialize an empty ready list.  If "timeSliced", threads take
+//	turns; otherwise each runs until it blocks or yields.
+//----------------------------------------------------------------------
+
+FifoPolicy::FifoPolicy(bool sliced)
+{
+    readyList = new List<Thread *>;
+    timeSliced = sliced;
+}
+
+//----------------------------------------------------------------------
+// FifoPolicy::~FifoPolicy
+// 	De-allocate the ready list.
+//----------------------------------------------------------------------
+
+FifoPolicy::~FifoPolicy()
+{
+    delete readyList;
+}
+
+//----------------------------------------------------------------------
+// FifoPolicy::Insert
+// 	Put "thread" at the end of the ready list.
+//----------------------------------------------------------------------
+
+void
+FifoPolicy::Insert(Thread *thread)
+{
+    readyList->Append(thread);
+}
+
+//----------------------------------------------------------------------
+// FifoPolicy::RemoveNext
+// 	Take out the thread that has been ready longest.
+//----------------------------------------------------------------------
+
+Thread *
+FifoPolicy::RemoveNext()
+{
+    if (readyList->IsEmpty()) {
+	return NULL;
+    }
+    return readyList->RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// FifoPolicy::Apply
+// 	Call "func" on every ready thread, in order.
+//----------------------------------------------------------------------
+
+void
+FifoPolicy::Apply(void (*func)(Thread *))
+{
+    readyList->Apply(func);
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::ShortestJobPolicy
+// 	Initialize an empty ready queue.
+//----------------------------------------------------------------------
+
+ShortestJobPolicy::ShortestJobPolicy()
+{
+    readyQueue = new BurstQueue;
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::~ShortestJobPolicy
+// 	De-allocate the ready queue.
+//----------------------------------------------------------------------
+
+ShortestJobPolicy::~ShortestJobPolicy()
+{
+    delete readyQueue;
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::Insert
+// 	Put "thread" in the queue, by its estimated burst time.
+//----------------------------------------------------------------------
+
+void
+ShortestJobPolicy::Insert(Thread *thread)
+{
+    readyQueue->Insert(thread);
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::RemoveNext
+// 	Take out the thread with the shortest estimated burst.
+//----------------------------------------------------------------------
+
+Thread *
+ShortestJobPolicy::RemoveNext()
+{
+    return readyQueue->RemoveFront();
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::Preempts
+// 	A thread made ready preempts the current thread if it is
+//	expected to be shorter than what the current thread has left.
+//----------------------------------------------------------------------
+
+bool
+ShortestJobPolicy::Preempts(Thread *thread)
+{
+    return ShorterThanCurrent(thread);
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::Stopped
+// 	Estimate the next burst of "thread".
+//----------------------------------------------------------------------
+
+void
+ShortestJobPolicy::Stopped(Thread *thread)
+{
+    EstimateBurst(thread);
+}
+
+//----------------------------------------------------------------------
+// ShortestJobPolicy::Apply
+// 	Call "func" on every ready thread, shortest first.
+//----------------------------------------------------------------------
+
+void
+ShortestJobPolicy::Apply(void (*func)(Thread *))
+{
+    readyQueue->Apply(func);
+}
+
+//----------------------------------------------------------------------
+// FairWeight
+// 	Return the weight of "thread", by its priority: from 15 for
+//	priority 0 to 88761 for 149, each step of 3.75 in priority
+//	giving about 25% more CPU time.  (The weights are those of nice
+//	levels 19 to -20 in Linux.)
+//----------------------------------------------------------------------
+
+static const int fairWeights[40] = {
+    88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+    9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277,
+    1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+    110, 87, 70, 56, 45, 36, 29, 23, 18, 15
+};
+
+static int
+FairWeight(Thread *thread)
+{
+    int p = thread->getPriority();
+
+    if (p < 0)
+	p = 0;
+    else if (p > 149)
+	p = 149;
+    return fairWeights[39 - p * 40 / 150];
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::FairPolicy
+// 	Initialize an empty ready queue.
+//----------------------------------------------------------------------
+
+FairPolicy::FairPolicy()
+{
+    readyQueue = new FairQueue;
+    minVruntime = 0;
+    totalWeight = 0;
+    charged = NULL;
+    chargedAt = 0;
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::~FairPolicy
+// 	De-allocate the ready queue.
+//----------------------------------------------------------------------
+
+FairPolicy::~FairPolicy()
+{
+    delete readyQueue;
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::Runtime
+// 	Return the virtual runtime of the running thread "thread",
+//	counting the part of this run it hasn't been charged for yet.
+//----------------------------------------------------------------------
+
+double
+FairPolicy::Runtime(Thread *thread)
+{
+    int from = thread->getStartTime();
+
+    if (thread == charged && chargedAt > from) {
+	from = chargedAt;
+    }
+    return thread->getVruntime() + (double) (kernel->stats->userTicks - from)
+				* FairNiceWeight / FairWeight(thread);
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::Insert
+// 	Put "thread" in the queue, by its virtual runtime.  A thread that
+//	was blocked (or is new) may have fallen far behind the others;
+//	it is credited at most half a latency, or it would have the CPU
+//	to itself until it caught up.
+//----------------------------------------------------------------------
+
+void
+FairPolicy::Insert(Thread *thread)
+{
+    double vruntime = thread->getVruntime();
+
+    if (vruntime < minVruntime - FairLatency / 2) {
+	vruntime = minVruntime - FairLatency / 2;
+	thread->setVruntime(vruntime);
+    }
+    DEBUG(dbgThread, "Fair queue: thread " << thread->getID()
+		<< ", virtual runtime " << vruntime);
+    readyQueue->Insert(thread, vruntime);
+    totalWeight += FairWeight(thread);
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::RemoveNext
+// 	Take out the thread with the least virtual runtime.
+//----------------------------------------------------------------------
+
+Thread *
+FairPolicy::RemoveNext()
+{
+    Thread *thread = readyQueue->RemoveFront();
+
+    if (thread == NULL) {
+	return NULL;
+    }
+    totalWeight -= FairWeight(thread);
+    if (thread->getVruntime() > minVruntime) {
+	minVruntime = thread->getVruntime();
+    }
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::Preempts
+// 	A thread made ready preempts the current thread if it has had
+//	less CPU time, by more than a minimum slice: not for every small
+//	difference.
+//----------------------------------------------------------------------
+
+bool
+FairPolicy::Preempts(Thread *thread)
+{
+    Thread *current = kernel->currentThread;
+
+    if (current->getID() == thread->getID()) {
+	return FALSE;
+    }
+    return Runtime(current) - thread->getVruntime()
+		> (double) FairMinSlice * FairNiceWeight / FairWeight(thread);
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::TimeSliced
+// 	Return TRUE if "thread" has used up its slice: its share, by
+//	weight, of the time in which every ready thread should run once.
+//	That is FairLatency, unless so many threads are ready that they
+//	would get less than FairMinSlice each.
+//----------------------------------------------------------------------
+
+bool
+FairPolicy::TimeSliced(Thread *thread)
+{
+    int ran = kernel->stats->userTicks - thread->getStartTime();
+    int numThreads = readyQueue->NumInQueue() + 1;
+    int weight = FairWeight(thread);
+    double period = FairLatency;
+    double slice;
+
+    if (numThreads * FairMinSlice > FairLatency) {
+	period = numThreads * FairMinSlice;
+    }
+    slice = period * weight / (totalWeight + weight);
+    if (slice < FairMinSlice) {
+	slice = FairMinSlice;
+    }
+    return ran >= slice;
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::Stopped
+// 	Charge "thread" for the CPU time it has just had.
+//----------------------------------------------------------------------
+
+void
+FairPolicy::Stopped(Thread *thread)
+{
+    thread->setVruntime(Runtime(thread));
+    charged = thread;
+    chargedAt = kernel->stats->userTicks;
+}
+
+//----------------------------------------------------------------------
+// FairPolicy::Apply
+// 	Call "func" on every ready thread, least virtual runtime first.
+//----------------------------------------------------------------------
+
+void
+FairPolicy::Apply(void (*func)(Thread *))
+{
+    readyQueue->Apply(func);
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::DeadlinePolicy
+// 	Initialize the real-time class, with no real-time threads yet.
+//	"basePolicy" schedules the others.
+//----------------------------------------------------------------------
+
+DeadlinePolicy::DeadlinePolicy(SchedulingPolicy *basePolicy)
+{
+    base = basePolicy;
+    readyQueue = new FairQueue;
+    tasks = new List<Thread *>;
+    share = 0;
+    timerAt = 0;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::~DeadlinePolicy
+// 	De-allocate the queues, and the policy underneath.
+//----------------------------------------------------------------------
+
+DeadlinePolicy::~DeadlinePolicy()
+{
+    delete readyQueue;
+    delete tasks;
+    delete base;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Used
+// 	Return the CPU time real-time "thread" has had in this period,
+//	counting the current run if it is running.
+//----------------------------------------------------------------------
+
+int
+DeadlinePolicy::Used(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+
+    if (thread == kernel->currentThread && thread->getStatus() == RUNNING) {
+	return task->used + kernel->stats->totalTicks - task->runStart;
+    }
+    return task->used;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::MustYield
+// 	Return TRUE if the running "thread" must give up the CPU: it is
+//	real-time and has had its budget, or a ready real-time thread has
+//	an earlier deadline.
+//----------------------------------------------------------------------
+
+bool
+DeadlinePolicy::MustYield(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+    Thread *next = readyQueue->Front();
+
+    if (task != NULL && Used(thread) >= task->budget) {
+	return TRUE;
+    }
+    if (next == NULL) {
+	return FALSE;
+    }
+    return task == NULL || next->getRealTime()->deadline < task->deadline;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::NextPeriod
+// 	If the period of real-time "thread" is over, start the one it is
+//	in now, with a new budget.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::NextPeriod(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+    int nowTime = kernel->stats->totalTicks;
+
+    if (task->deadline > nowTime) {
+	return;
+    }
+    while (task->deadline <= nowTime) {
+	task->deadline += task->period;
+	kernel->stats->numDeadlinePeriods++;
+    }
+    task->used = 0;
+    task->runStart = nowTime;
+    task->throttled = FALSE;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::SetTimer
+// 	Have the timer interrupt at tick "when", unless it already will
+//	by then.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::SetTimer(int when)
+{
+    int nowTime = kernel->stats->totalTicks;
+
+    if (when <= nowTime) {
+	when = nowTime + 1;
+    }
+    if (timerAt > nowTime && timerAt <= when) {
+	return;
+    }
+    kernel->interrupt->Schedule(this, when - nowTime, TimerInt);
+    timerAt = when;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Insert
+// 	Put a real-time thread in the queue, by its deadline, unless it
+//	has had its budget for this period: then it is throttled until
+//	the next.  Other threads go to the base policy.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::Insert(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+
+    if (task == NULL) {
+	base->Insert(thread);
+	return;
+    }
+    NextPeriod(thread);		// it may have been blocked a while
+    if (task->used >= task->budget) {
+	DEBUG(dbgThread, "Real-time thread " << thread->getID()
+		<< " throttled until " << task->deadline);
+	task->throttled = TRUE;
+    } else {
+	DEBUG(dbgThread, "Real-time queue: thread " << thread->getID()
+		<< ", deadline " << task->deadline);
+	readyQueue->Insert(thread, task->deadline);
+    }
+    SetTimer(task->deadline);
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::RemoveNext
+// 	Take out the real-time thread with the earliest deadline, and
+//	have the timer interrupt when its budget runs out; if none is
+//	ready, ask the base policy.
+//----------------------------------------------------------------------
+
+Thread *
+DeadlinePolicy::RemoveNext()
+{
+    Thread *thread = readyQueue->RemoveFront();
+    RealTimeTask *task;
+
+    if (thread == NULL) {
+	return base->RemoveNext();
+    }
+    task = thread->getRealTime();
+    task->runStart = kernel->stats->totalTicks;
+    SetTimer(task->runStart + task->budget - task->used);
+    return thread;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Preempts
+// 	A real-time thread made ready preempts any other thread, and a
+//	real-time thread with a later deadline.  Between the others, the
+//	base policy decides.
+//----------------------------------------------------------------------
+
+bool
+DeadlinePolicy::Preempts(Thread *thread)
+{
+    Thread *current = kernel->currentThread;
+    RealTimeTask *task = thread->getRealTime();
+
+    if (current->getID() == thread->getID()) {
+	return FALSE;
+    }
+    if (task != NULL) {
+	return !task->throttled && (current->getRealTime() == NULL
+		|| task->deadline < current->getRealTime()->deadline);
+    }
+    if (current->getRealTime() != NULL) {
+	return FALSE;
+    }
+    return base->Preempts(thread);
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::TimeSliced
+// 	A real-time thread runs until its budget runs out, or a thread
+//	with an earlier deadline is ready.  Any other thread gives up the
+//	CPU to a ready real-time thread; otherwise the base policy
+//	decides.
+//----------------------------------------------------------------------
+
+bool
+DeadlinePolicy::TimeSliced(Thread *thread)
+{
+    if (MustYield(thread)) {
+	return TRUE;
+    }
+    if (thread->getRealTime() != NULL) {
+	return FALSE;
+    }
+    return base->TimeSliced(thread);
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Stopped
+// 	Charge a real-time "thread" for the CPU time it has just had.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::Stopped(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+    int nowTime = kernel->stats->totalTicks;
+
+    if (task == NULL) {
+	base->Stopped(thread);
+	return;
+    }
+    task->used += nowTime - task->runStart;
+    task->runStart = nowTime;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Apply
+// 	Call "func" on every ready thread, real-time threads first.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::Apply(void (*func)(Thread *))
+{
+    readyQueue->Apply(func);
+    base->Apply(func);
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::SetDeadline
+// 	Make the running "thread" real-time, with "budget" ticks of CPU
+//	time every "period" ticks, starting now; a thread that already
+//	is starts over with the new figures.  It is admitted only if the
+//	real-time threads would still be promised at most
+//	MaxRealTimeShare of the CPU: otherwise none of them could count
+//	on its budget.  A period and budget of 0 make it an ordinary
+//	thread again.
+//
+//	Returns 0 if admitted, -1 if not.  Made ordinary again, returns
+//	the number of deadlines the thread missed while real-time.
+//----------------------------------------------------------------------
+
+int
+DeadlinePolicy::SetDeadline(Thread *thread, int period, int budget)
+{
+    RealTimeTask *task = thread->getRealTime();
+    double oldShare = 0;
+    int nowTime;
+    IntStatus oldLevel;
+
+    ASSERT(thread == kernel->currentThread);
+    if (period == 0 && budget == 0) {
+	int missed = (task == NULL) ? 0 : task->missed;
+
+	Leave(thread);
+	return missed;
+    }
+    if (period <= 0 || budget <= 0 || budget > period) {
+	return -1;
+    }
+    if (task != NULL) {
+	oldShare = (double) task->budget / task->period;
+    }
+    if (share - oldShare + (double) budget / period > MaxRealTimeShare) {
+	DEBUG(dbgThread, "Real-time thread " << thread->getID()
+		<< " not admitted: " << budget << "/" << period);
+	kernel->stats->numAdmissionRejects++;
+	return -1;
+    }
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    if (task == NULL) {
+	task = new RealTimeTask;
+	task->missed = 0;
+	thread->setRealTime(task);
+	tasks->Append(thread);
+    }
+    share += (double) budget / period - oldShare;
+    nowTime = kernel->stats->totalTicks;
+    task->period = period;
+    task->budget = budget;
+    task->deadline = nowTime + period;
+    task->used = 0;
+    task->runStart = nowTime;
+    task->throttled = FALSE;
+    DEBUG(dbgThread, "Real-time thread " << thread->getID() << ": "
+		<< budget << "/" << period << ", deadline " << task->deadline);
+    SetTimer(nowTime + budget);
+    SetTimer(task->deadline);
+    if (MustYield(thread)) {
+	thread->Yield();
+    }
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    return 0;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Leave
+// 	"thread" is no longer real-time: it has asked not to be, or it
+//	is being deleted.  It must not be in the ready queue.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::Leave(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+
+    if (task == NULL) {
+	return;
+    }
+    ASSERT(thread->getStatus() != READY || task->throttled);
+    share -= (double) task->budget / task->period;
+    tasks->Remove(thread);
+    thread->setRealTime(NULL);
+    delete task;
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::Throttle
+// 	The running real-time "thread" is done with its work for this
+//	period: give up the rest of its budget, and wait for the next
+//	period.  An ordinary thread just yields.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::Throttle(Thread *thread)
+{
+    RealTimeTask *task = thread->getRealTime();
+    IntStatus oldLevel;
+
+    ASSERT(thread == kernel->currentThread);
+    if (task == NULL) {
+	thread->Yield();
+	return;
+    }
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    task->throttled = TRUE;
+    SetTimer(task->deadline);
+    thread->Sleep(FALSE);		// until CallBack starts its period
+    (void) kernel->interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// DeadlinePolicy::CallBack
+// 	Called on a timer interrupt, with interrupts disabled.  Start a
+//	new period for each real-time thread whose deadline has come;
+//	one that is still waiting for the CPU, or running short of its
+//	budget, has missed it.  A throttled thread is ready again.
+//
+//	Then have the timer interrupt at the next deadline, or when the
+//	running thread's budget runs out, and preempt it if it must
+//	give up the CPU.  A thread blocked for something else is left
+//	alone: its period is brought up to date when it wakes up.
+//----------------------------------------------------------------------
+
+void
+DeadlinePolicy::CallBack()
+{
+    Thread *current = kernel->currentThread;
+    int nowTime = kernel->stats->totalTicks;
+    int next = 0;
+    ListIterator<Thread *> iter(tasks);
+
+    timerAt = 0;
+    for (; !iter.IsDone(); iter.Next()) {
+	Thread *thread = iter.Item();
+	RealTimeTask *task = thread->getRealTime();
+
+	if (thread->getStatus() == BLOCKED && !task->throttled) {
+	    continue;
+	}
+	if (task->deadline <= nowTime) {
+	    if (!task->throttled && (thread->getStatus() == READY
+		    || (thread == current && Used(thread) < task->budget))) {
+		DEBUG(dbgThread, "Real-time thread " << thread->getID()
+			<< " missed deadline " << task->deadline);
+		kernel->stats->numDeadlineMisses++;
+		task->missed++;
+	    }
+	    if (task->throttled) {
+		NextPeriod(thread);
+		thread->setStatus(READY);
+		readyQueue->Insert(thread, task->deadline);
+	    } else {
+		NextPeriod(thread);	// if ready, it keeps its place
+	    }
+	}
+	if (next == 0 || task->deadline < next) {
+	    next = task->deadline;
+	}
+    }
+    if (current->getRealTime() != NULL) {
+	RealTimeTask *task = current->getRealTime();
+	int budgetEnd = nowTime + task->budget - Used(current);
+
+	if (budgetEnd > nowTime && (next == 0 || budgetEnd < next)) {
+	    next = budgetEnd;
+	}
+    }
+    if (next != 0) {
+	SetTimer(next);
+    }
+    if (kernel->interrupt->getStatus() != IdleMode && MustYield(current)) {
+	kernel->interrupt->YieldOnReturn();
+    }
+}
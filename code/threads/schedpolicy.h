@@ -0,0 +1,236 @@
+// schedpolicy.h
+//	Data structures for the scheduling policies.
+//
+//	The scheduler (see scheduler.h) dispatches threads; which ready
+//	thread runs next is up to its policy.  A policy keeps the ready
+//	threads in its own queues, and decides when the running thread
+//	must give up the CPU: when another thread becomes ready, at the
+//	end of a time slice, or on a tick.
+//
+//	The policy is chosen with -sched; the default is the MP3
+//	multilevel queue:
+//
+//	  mlfq	L1 shortest job first (preemptive), L2 by priority, L3
+//		round robin, with aging from one queue to the next
+//	  rr	round robin, in the order threads become ready
+//	  fifo	first come, first served; a thread runs until it blocks
+//	  sjf	shortest (estimated) job first, preemptive
+//	  cfs	completely fair: each thread gets a share of the CPU
+//		by its priority
+//
+//	Whichever it is, real-time threads come first.  A thread asks,
+//	with the SetDeadline system call, for "budget" ticks of CPU time
+//	every "period" ticks; if there is room, it is admitted, and runs
+//	ahead of every other thread, earliest deadline first, until it
+//	has had its budget (see DeadlinePolicy).
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SCHEDPOLICY_H
+#define SCHEDPOLICY_H
+
+#include "copyright.h"
+#include "list.h"
+#include "readyqueue.h"
+#include "callback.h"
+
+class Thread;
+
+// The following class defines what the scheduler asks of a policy.
+// Like the scheduler, it is called with interrupts disabled, except
+// for Tick.
+
+class SchedulingPolicy {
+  public:
+    virtual ~SchedulingPolicy() {}
+
+    virtual void Insert(Thread *thread) = 0;
+				// Put ready "thread" in the queues
+    virtual Thread *RemoveNext() = 0;
+				// Take out the thread to run next;
+				// NULL if none is ready
+    virtual bool Preempts(Thread *thread) { return FALSE; }
+				// Must the current thread yield to
+				// "thread", just made ready?
+    virtual bool TimeSliced(Thread *thread) { return TRUE; }
+				// Does "thread" give up the CPU at
+				// the end of a time slice?
+    virtual void Stopped(Thread *thread) {}
+				// "thread" is giving up the CPU
+    virtual void Tick() {}	// Called on every tick
+    virtual void Apply(void (*func)(Thread *)) = 0;
+				// Call "func" on each ready thread
+};
+
+extern SchedulingPolicy *NewSchedulingPolicy(char *name);
+				// The policy called "name", NULL if
+				// there is none
+
+// The MP3 multilevel feedback queue.
+
+class MultilevelPolicy : public SchedulingPolicy {
+  public:
+    MultilevelPolicy();
+    ~MultilevelPolicy();
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool Preempts(Thread *thread);
+    bool TimeSliced(Thread *thread);
+    void Stopped(Thread *thread);
+    void Tick();		// Age the threads waiting too long
+    void Apply(void (*func)(Thread *));
+
+  private:
+    bool CheckAging(Thread *thread);
+    void ResetWait(Thread *thread);
+				// "thread" starts waiting again
+
+    BurstQueue *L1Queue;	// by burst time
+    PriorityQueue *L2Queue;	// by priority
+    List<Thread *> *L3Queue;	// round robin
+    AgingQueue *agingQueue;	// all of them, longest waiting first
+    unsigned int numQueued;	// to stamp threads as they are queued
+};
+
+// Round robin, or first come first served.
+
+class FifoPolicy : public SchedulingPolicy {
+  public:
+    FifoPolicy(bool timeSliced);
+    ~FifoPolicy();
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool TimeSliced(Thread *thread) { return timeSliced; }
+    void Apply(void (*func)(Thread *));
+
+  private:
+    List<Thread *> *readyList;
+    bool timeSliced;		// round robin
+};
+
+// Shortest job first, on the burst time estimated from past bursts.
+
+class ShortestJobPolicy : public SchedulingPolicy {
+  public:
+    ShortestJobPolicy();
+    ~ShortestJobPolicy();
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool Preempts(Thread *thread);
+    bool TimeSliced(Thread *thread) { return FALSE; }
+    void Stopped(Thread *thread);
+    void Apply(void (*func)(Thread *));
+
+  private:
+    BurstQueue *readyQueue;
+};
+
+// The completely fair scheduler.  Each thread is charged the user
+// ticks it runs, weighted by its priority: its virtual runtime.  The
+// ready thread that has had the least runs next, for a slice that
+// gets shorter as more threads are ready, so that each runs within
+// FairLatency ticks.  A thread made ready preempts one that has had
+// FairMinSlice (weighted) ticks more than it.
+
+const int FairLatency = 1000;		// ticks to run every ready thread
+const int FairMinSlice = 100;		// shortest time slice
+const int FairNiceWeight = 1024;	// weight for which virtual runtime
+					// is real time
+
+class FairPolicy : public SchedulingPolicy {
+  public:
+    FairPolicy();
+    ~FairPolicy();
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool Preempts(Thread *thread);
+    bool TimeSliced(Thread *thread);
+    void Stopped(Thread *thread);
+    void Apply(void (*func)(Thread *));
+
+  private:
+    double Runtime(Thread *thread);	// Virtual runtime of the running
+					// "thread", up to now
+
+    FairQueue *readyQueue;		// by virtual runtime
+    double minVruntime;			// never decreases
+    int totalWeight;			// of the ready threads
+    Thread *charged;			// charged for its run so far,
+    int chargedAt;			// up to this user tick
+};
+
+// A real-time thread wants "budget" ticks of CPU time in each of its
+// periods; the current period ends at "deadline".  The ticks count
+// all the time it runs, in the kernel too.
+
+class RealTimeTask {
+  public:
+    int period;
+    int budget;
+    int deadline;		// end of the current period
+    int used;			// CPU time had in this period,
+    int runStart;		// ... up to this tick, if it is running
+    bool throttled;		// waits for its next period
+    int missed;			// deadlines it has missed
+};
+
+// Real-time threads are admitted only while their budgets add up to at
+// most this much of the CPU, to leave time for the other threads.
+
+const double MaxRealTimeShare = 0.9;
+
+// The real-time class, over any other policy.  Ready real-time threads
+// run first, earliest deadline first; the others are left to "base".
+//
+// A real-time thread that has had its budget for the period gives up
+// the CPU, and is throttled: it is not ready again until its period
+// ends.  The timer interrupts when the running thread's budget runs
+// out, and when a period ends; a thread still waiting for the CPU then
+// has missed its deadline.
+
+class DeadlinePolicy : public SchedulingPolicy, public CallBackObj {
+  public:
+    DeadlinePolicy(SchedulingPolicy *basePolicy);
+    ~DeadlinePolicy();
+
+    void Insert(Thread *thread);
+    Thread *RemoveNext();
+    bool Preempts(Thread *thread);
+    bool TimeSliced(Thread *thread);
+    void Stopped(Thread *thread);
+    void Tick() { base->Tick(); }
+    void Apply(void (*func)(Thread *));
+
+    int SetDeadline(Thread *thread, int period, int budget);
+				// Make the running "thread" real-time;
+				// 0 if admitted, -1 if not
+    void Leave(Thread *thread);	// "thread" is no longer real-time
+    void Throttle(Thread *thread);
+				// The running "thread" is done for
+				// this period: wait for the next
+
+    void CallBack();		// Called on a timer interrupt
+
+  private:
+    int Used(Thread *thread);	// CPU time "thread" has had this period
+    bool MustYield(Thread *thread);
+				// Must the running "thread" give up
+				// the CPU now?
+    void NextPeriod(Thread *thread);
+				// Start the period "thread" is in now
+    void SetTimer(int when);	// Interrupt at tick "when"
+
+    SchedulingPolicy *base;	// for the other threads
+    FairQueue *readyQueue;	// ready real-time threads, by deadline
+    List<Thread *> *tasks;	// all the real-time threads
+    double share;		// of the CPU they are promised
+    int timerAt;		// when the timer will next interrupt
+};
+
+#endif // SCHEDPOLICY_H
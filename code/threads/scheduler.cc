@@ -11,8 +11,8 @@
 //	end up calling FindNextToRun(), and that would put us in an
 //	infinite loop.
 //
-// 	Very simple implementation -- no priorities, straight FIFO.
-//	Might need to be improved in later assignments.
+// 	Which ready thread runs next is up to the scheduling policy
+//	(see schedpolicy.h).
 //
 // Copyright (c) 1992-1996 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation
@@ -29,93 +29,18 @@ using namespace std;
 //----------------------------------------------------------------------
 // Scheduler::Scheduler
 // 	Initialize the list of ready but not running threads.
-//	Initially, no ready threads.
+//	Initially, no ready threads.  "readyPolicy" decides which
+//	of them runs next, after any real-time threads.
 //----------------------------------------------------------------------
 
-
-/* MP3 Compare func */
-int burstCmp(Thread *a, Thread *b)
-{
-    int aTime = a->getBurstTime();
-    int bTime = b->getBurstTime();
-    if(aTime == bTime)  return 0;
-    else if(aTime > bTime) return 1;
-    else return -1;
-}
-
-int priorityCmp(Thread *a, Thread *b)
-{
-    int aPriority = a->getPriority();
-    int bPriority = b->getPriority();
-    if(aPriority == bPriority)  return 0;
-    else if(aPriority > bPriority) return -1;
-    else return 1;
-}
-
-/* MP3 Check aging */
-bool Scheduler::CheckAging(Thread *thread)
-{
-    int nowTime = kernel->stats->totalTicks;
-    /* In ready queue and wait time >= 1500 */
-    if(thread->getStatus() == READY && nowTime - thread->getStartWaitTime() >= 1500)
-    {
-        /* Aging */
-        int oldPriority = thread->getPriority();
-        int newPriority = (oldPriority + 10 > 149) ? 149 : oldPriority + 10;
-        thread->setPriority(newPriority);
-        if(oldPriority != newPriority){
-          cout << "Tick " << nowTime << ": Thread " << thread->getID();
-          cout << " changes its priority from " << oldPriority << " to " << newPriority << endl;
-        }
-
-        if(newPriority >= 100 && newPriority < 110) /* L2 -> L1 */
-        {
-            if(kernel->scheduler->L2Queue->IsInList(thread))
-                kernel->scheduler->L2Queue->Remove(thread);
-            kernel->scheduler->L1Queue->Insert(thread);
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is removed from queue L2" << endl;
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L1"<< endl;
-
-            /* Preemptive , Only SJF */
-            if( 100 <= kernel->currentThread->getPriority() && kernel->currentThread->getPriority() <= 149 )
-            {
-   	          if(kernel->currentThread->getID() != thread->getID())
-              {
-   	            double actBurst = kernel->stats->userTicks - kernel->currentThread->getStartTime();
-		            double estBurst = 0.5 * actBurst + 0.5 * kernel->currentThread->getBurstTime();
-                if(thread->getBurstTime() < estBurst)
-                  kernel->currentThread->Yield();
-              }
-            }
-            /* Reset wait time */
-            thread->setStartWaitTime(nowTime);
-            return TRUE;
-        }
-        else if(newPriority >= 50 && newPriority < 60) /* L3 -> L2 */
-        {
-            kernel->scheduler->readyList->Remove(thread);
-            kernel->scheduler->L2Queue->Insert(thread);
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is removed from queue L3" << endl;
-            cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L2" << endl;
-        }
-        /* Reset wait time */
-        thread->setStartWaitTime(nowTime);
-    }
-    return FALSE;
-}
-
-Scheduler::Scheduler()
+Scheduler::Scheduler(SchedulingPolicy *readyPolicy)
 {
-    readyList = new List<Thread *>;
+    policy = new DeadlinePolicy(readyPolicy);
     toBeDestroyed = NULL;
-
-    /* MP3 Init Queue */
-    L1Queue = new SortedList<Thread *>(burstCmp);
-    L2Queue = new SortedList<Thread *>(priorityCmp);
+    userThread = NULL;
+    loadedSpace = NULL;
 }
 
-
-
 //----------------------------------------------------------------------
 // Scheduler::~Scheduler
 // 	De-allocate the list of ready threads.
@@ -123,13 +48,18 @@ Scheduler::Scheduler()
 
 Scheduler::~Scheduler()
 {
-    delete readyList;
+    delete policy;
 }
 
 //----------------------------------------------------------------------
 // Scheduler::ReadyToRun
 // 	Mark a thread as ready, but not running.
 //	Put it on the ready list, for later scheduling onto the CPU.
+//	If the policy says so, the current thread yields to it, once the
+//	interrupt handler returns or the caller re-enables interrupts:
+//	not here, where the caller may be half way through waking it up.
+//	When the machine is idle there is nothing to yield: the idle
+//	loop in Thread::Sleep finds the thread.
 //
 //	"thread" is the thread to be put on the ready list.
 //----------------------------------------------------------------------
@@ -142,43 +72,11 @@ Scheduler::ReadyToRun (Thread *thread)
 	//cout << "Putting thread on ready list: " << thread->getName() << endl ;
     thread->setStatus(READY);
 
-    /* MP3 into queue */
-    int p = thread->getPriority();
-    int nowTime = kernel->stats->totalTicks;
-    cout << "Tick " << nowTime << ": Thread " << thread->getID() << " is inserted into queue L";
-    if(100 <=  p && p <= 149)
-	{
-        L1Queue->Insert(thread);
-        cout << 1 << endl;
-    }
-	else if(50 <= p && p <= 99)
-    {
-		L2Queue->Insert(thread);
-        cout << 2 << endl;
-    }
-	else
-    {
-     readyList->Append(thread);
-     cout << 3 << endl;
-    }
-
-    /* MP3 Aging , now thread starts to wait */
-    thread->setStartWaitTime(nowTime);
-
-    /* MP3 preemptive , only SJF */
-    if(100 <=  p && p <= 149) /* something is added into L1 queue */
-    {
-        if( 100 <= kernel->currentThread->getPriority() && kernel->currentThread->getPriority() <= 149 )
-        {
-          if(kernel->currentThread->getID() != thread->getID())
-          {
-   	        double actBurst = kernel->stats->userTicks - kernel->currentThread->getStartTime();
-		        double estBurst = 0.5 * actBurst + 0.5 * kernel->currentThread->getBurstTime();
-            if(thread->getBurstTime() < estBurst)
-              kernel->currentThread->Yield();
-          }
-        }
-    }
+    policy->Insert(thread);
+    if (policy->Preempts(thread)
+		&& kernel->interrupt->getStatus() != IdleMode
+		&& kernel->currentThread->getStatus() == RUNNING)
+        kernel->interrupt->PreemptOnReturn();
 }
 
 //----------------------------------------------------------------------
@@ -194,31 +92,7 @@ Scheduler::FindNextToRun ()
 {
     ASSERT(kernel->interrupt->getLevel() == IntOff);
 
-    /* MP3 Which is Next ? */
-    int nowTime = kernel->stats->totalTicks;
-    if(!L1Queue->IsEmpty())
-    {
-        cout << "Tick " << nowTime << ": Thread " << L1Queue->Front()->getID() << " is removed from queue L";
-        cout << 1 << endl;
-
-        return L1Queue->RemoveFront();
-    }
-    else if(!L2Queue->IsEmpty())
-    {
-        cout << "Tick " << nowTime << ": Thread " << L2Queue->Front()->getID() << " is removed from queue L";
-        cout << 2 << endl;
-
-        return L2Queue->RemoveFront();
-    }
-    else if (!readyList->IsEmpty())
-    {
-        cout << "Tick " << nowTime << ": Thread " << readyList->Front()->getID() << " is removed from queue L";
-        cout << 3 << endl;
-
-        return readyList->RemoveFront();
-    }
-    else
-        return NULL;
+    return policy->RemoveNext();
 }
 
 //----------------------------------------------------------------------
@@ -263,11 +137,11 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 	 toBeDestroyed = oldThread;
     }
 
-    if (oldThread->space != NULL) {	// if this thread is a user program,
-        oldThread->SaveUserState(); 	// save the user's CPU registers
-	oldThread->space->SaveState();
-    }
+    // The user registers and translations of the old thread stay in
+    // the machine: they are only saved when another user thread needs
+    // the machine (see LoadUserState).
 
+    kernel->stats->numContextSwitches++;
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
 
@@ -300,11 +174,54 @@ Scheduler::Run (Thread *nextThread, bool finishing)
 					// and needs to be cleaned up
 
     if (oldThread->space != NULL) {	    // if there is an address space
-        oldThread->RestoreUserState();     // to restore, do it.
-	oldThread->space->RestoreState();
+        LoadUserState(oldThread);	    // to restore, do it.
     }
 }
 
+//----------------------------------------------------------------------
+// Scheduler::LoadUserState
+// 	Make the machine run user thread "thread": load its registers,
+//	and the translations of its address space.  Either may still be
+//	in the machine, from the last time a user thread ran: kernel
+//	threads don't touch them, and threads of one address space share
+//	its translations.  Then nothing needs copying, or flushing.
+//
+//	Whatever is replaced is saved first: the registers of the thread
+//	that last ran user code, the TLB bits of its address space.
+//----------------------------------------------------------------------
+
+void
+Scheduler::LoadUserState(Thread *thread)
+{
+    if (userThread != thread) {
+	if (userThread != NULL)
+	    userThread->SaveUserState();
+	thread->RestoreUserState();
+	userThread = thread;
+	kernel->stats->numUserStateLoads++;
+    }
+    if (loadedSpace != thread->space) {
+	if (loadedSpace != NULL)
+	    loadedSpace->SaveState();
+	thread->space->RestoreState();
+	loadedSpace = thread->space;
+	kernel->stats->numSpaceLoads++;
+    }
+}
+
+//----------------------------------------------------------------------
+// Scheduler::ForgetSpace
+// 	Address space "space" is being de-allocated; if its translations
+//	are in the machine, there is no need to save them.
+//----------------------------------------------------------------------
+
+void
+Scheduler::ForgetSpace(AddrSpace *space)
+{
+    if (loadedSpace == space)
+	loadedSpace = NULL;
+}
+
 //----------------------------------------------------------------------
 // Scheduler::CheckToBeDestroyed
 // 	If the old thread gave up the processor because it was finishing,
@@ -317,6 +234,8 @@ void
 Scheduler::CheckToBeDestroyed()
 {
     if (toBeDestroyed != NULL) {
+	if (userThread == toBeDestroyed)	// its registers are
+	    userThread = NULL;			// no longer needed
         delete toBeDestroyed;
 	toBeDestroyed = NULL;
     }
@@ -331,5 +250,5 @@ void
 Scheduler::Print()
 {
     cout << "Ready list contents:\n";
-    readyList->Apply(ThreadPrint);
+    policy->Apply(ThreadPrint);
 }
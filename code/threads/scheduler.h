@@ -12,6 +12,7 @@
 #include "copyright.h"
 #include "list.h"
 #include "thread.h"
+#include "schedpolicy.h"
 
 // The following class defines the scheduler/dispatcher abstraction --
 // the data structures and operations needed to keep track of which
@@ -19,7 +20,8 @@
 
 class Scheduler {
   public:
-    Scheduler();		// Initialize list of ready threads
+    Scheduler(SchedulingPolicy *readyPolicy);
+				// Initialize list of ready threads
     ~Scheduler();		// De-allocate ready list
 
     void ReadyToRun(Thread* thread);
@@ -30,22 +32,30 @@ class Scheduler {
     				// Cause nextThread to start running
     void CheckToBeDestroyed();// Check if thread that had been
     				// running needs to be deleted
+    void LoadUserState(Thread *thread);
+				// Load the user registers and
+				// translations of "thread"
+    void ForgetSpace(AddrSpace *space);
+				// "space" is going away
+    AddrSpace *LoadedSpace() { return loadedSpace; }
+				// Whose translations (and TLB
+				// entries) are in the machine
+    SchedulingPolicy *Policy() { return policy; }
+				// Which ready thread runs next
+    DeadlinePolicy *RealTime() { return policy; }
+				// ... among which the real-time
+				// threads come first
     void Print();		// Print contents of ready list
 
     // SelfTest for scheduler is implemented in class Thread
 
-    /* MP3 */
-    bool CheckAging(Thread *thread);
-    List<Thread *> *readyList;  // queue of threads that are ready to run,
-    /* MP3 add 2 more queue */
-    SortedList<Thread *> *L1Queue;
-    SortedList<Thread *> *L2Queue;
-
   private:
-
-				// but not running
+    DeadlinePolicy *policy;	// keeps the threads that are ready to
+				// run, but not running
     Thread *toBeDestroyed;	// finishing thread to be destroyed
     				// by the next thread that runs
+    Thread *userThread;		// whose registers are in the machine
+    AddrSpace *loadedSpace;	// whose translations are
 
 
 };
@@ -0,0 +1,85 @@
+// stackpool.cc
+//	Routines to hand out and take back thread stacks.
+//
+//	The pool is used by Thread::Fork and ~Thread, with interrupts
+//	on or off; since nothing here can cause a context switch, it
+//	needs no lock.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "stackpool.h"
+#include "sysdep.h"
+#include "debug.h"
+
+//----------------------------------------------------------------------
+// StackPool::StackPool
+// 	Initialize an empty pool, of stacks of "size" bytes.
+//----------------------------------------------------------------------
+
+StackPool::StackPool(int size)
+{
+    stackSize = size;
+    numFree = 0;
+    numAllocated = 0;
+    numReused = 0;
+}
+
+//----------------------------------------------------------------------
+// StackPool::~StackPool
+// 	Free the stacks in the pool.  Stacks still in use by threads
+//	are not ours to free.
+//----------------------------------------------------------------------
+
+StackPool::~StackPool()
+{
+    while (numFree > 0) {
+	DeallocBoundedArray(free[--numFree], stackSize);
+    }
+}
+
+//----------------------------------------------------------------------
+// StackPool::Get
+// 	Return a stack: the one freed most recently, still warm in the
+//	host's cache, or a new one if there is none.
+//----------------------------------------------------------------------
+
+char *
+StackPool::Get()
+{
+    if (numFree > 0) {
+	numReused++;
+	return free[--numFree];
+    }
+    numAllocated++;
+    return AllocBoundedArray(stackSize);
+}
+
+//----------------------------------------------------------------------
+// StackPool::Put
+// 	Take back "stack", for the next Get; free it if the pool is full.
+//----------------------------------------------------------------------
+
+void
+StackPool::Put(char *stack)
+{
+    if (numFree == MaxFreeStacks) {
+	DeallocBoundedArray(stack, stackSize);
+	return;
+    }
+    free[numFree++] = stack;
+}
+
+//----------------------------------------------------------------------
+// StackPool::PrintStats
+// 	Print how many stacks were allocated, and how many reused.
+//----------------------------------------------------------------------
+
+void
+StackPool::PrintStats()
+{
+    cout << "Thread stacks: " << numAllocated << " allocated, " << numReused
+	<< " reused, " << numFree << " free\n";
+}
@@ -0,0 +1,50 @@
+// stackpool.h
+//	Data structures for recycling thread execution stacks.
+//
+//	Each stack has a guard page at either end (see AllocBoundedArray),
+//	which takes two mprotect system calls to set up, and two more to
+//	undo.  So stacks of threads that finish are kept, and given to
+//	the next threads forked, instead of being freed; forking and
+//	deleting a thread then just pops and pushes a free list.
+//
+//	Stacks are only allocated when the pool is empty, and the host
+//	only commits the pages of a stack that are used.  At most
+//	MaxFreeStacks are kept: a burst of threads doesn't hold on to
+//	its memory for good.
+//
+//	There is one pool for each stack size; all threads use StackSize
+//	for now.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef STACKPOOL_H
+#define STACKPOOL_H
+
+#include "copyright.h"
+#include "utility.h"
+
+const int MaxFreeStacks = 64;		// free stacks kept for reuse
+
+// The following class defines a pool of stacks of one size.
+
+class StackPool {
+  public:
+    StackPool(int size);		// Stacks of "size" bytes
+    ~StackPool();			// Free the stacks in the pool
+
+    char *Get();			// Return a stack, reused if possible
+    void Put(char *stack);		// Give back a stack no longer used
+
+    void PrintStats();			// Print how well reuse worked
+
+  private:
+    int stackSize;			// in bytes
+    char *free[MaxFreeStacks];		// stacks ready for reuse
+    int numFree;
+    int numAllocated;			// # of AllocBoundedArray calls
+    int numReused;			// # of Gets from the free list
+};
+
+#endif // STACKPOOL_H
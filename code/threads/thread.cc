@@ -21,6 +21,7 @@
 #include "switch.h"
 #include "synch.h"
 #include "sysdep.h"
+#include "stackpool.h"
 
 // this is put at the top of the execution stack, for detecting stack overflows
 const int STACK_FENCEPOST = 0xdedbeef;
@@ -49,6 +50,12 @@ Thread::Thread(char* threadName, int threadID)
 
 	/* MP3 */
 	burstTime = 0;
+	startTime = 0;
+	priority = 0;
+	readyOrder = 0;
+	vruntime = 0;
+	realTime = NULL;
+	agingPrev = agingNext = NULL;
 }
 
 Thread::Thread(char* threadName, int threadID, int priority)
@@ -67,6 +74,11 @@ Thread::Thread(char* threadName, int threadID, int priority)
 
 	/* MP3 */
 	burstTime = 0;
+	startTime = 0;
+	readyOrder = 0;
+	vruntime = 0;
+	realTime = NULL;
+	agingPrev = agingNext = NULL;
 	this->priority = priority;
 }
 
@@ -86,8 +98,9 @@ Thread::~Thread()
 {
     DEBUG(dbgThread, "Deleting thread: " << name);
     ASSERT(this != kernel->currentThread);
+    kernel->scheduler->RealTime()->Leave(this);
     if (stack != NULL)
-	DeallocBoundedArray((char *) stack, StackSize * sizeof(int));
+	kernel->stackPool->Put((char *) stack);
 }
 
 //----------------------------------------------------------------------
@@ -232,12 +245,7 @@ Thread::Yield ()
     DEBUG(dbgThread, "Yielding thread: " << name);
 
 	/* SJF  */
-	if(this->getPriority() >= 100)
-	{
-		double actBurst = kernel->stats->userTicks - this->getStartTime();
-		double estBurst = 0.5 * actBurst + 0.5 * this->getBurstTime();
-		this->setBurstTime(estBurst);
-	}
+	kernel->scheduler->Policy()->Stopped(this);
 
 	  nextThread = kernel->scheduler->FindNextToRun();
     if (nextThread != NULL) {
@@ -282,12 +290,7 @@ Thread::Sleep (bool finishing)
 
 	/* MP3 Sleep */
 	/* SJF ? */
-	if(this->getPriority() >= 100)
-	{
-		double actBurst = kernel->stats->userTicks - this->getStartTime();
-		double estBurst = 0.5 * actBurst + 0.5 * this->getBurstTime();
-		this->setBurstTime(estBurst);
-	}
+	kernel->scheduler->Policy()->Stopped(this);
 
 	//cout << "debug Thread::Sleep " << name << "wait for Idle\n";
     while ((nextThread = kernel->scheduler->FindNextToRun()) == NULL) {
@@ -335,8 +338,9 @@ PLabelToAddr(void *plabel)
 
 //----------------------------------------------------------------------
 // Thread::StackAllocate
-//	Allocate and initialize an execution stack.  The stack is
-//	initialized with an initial stack frame for ThreadRoot, which:
+//	Allocate (from the stack pool) and initialize an execution stack.
+//	The stack is initialized with an initial stack frame for
+//	ThreadRoot, which:
 //		enables interrupts
 //		calls (*func)(arg)
 //		calls Thread::Finish
@@ -348,7 +352,7 @@ PLabelToAddr(void *plabel)
 void
 Thread::StackAllocate (VoidFunctionPtr func, void *arg)
 {
-    stack = (int *) AllocBoundedArray(StackSize * sizeof(int));
+    stack = (int *) kernel->stackPool->Get();
 
 #ifdef PARISC
     // HP stack works from low addresses to high addresses
@@ -459,10 +463,184 @@ SimpleThread(int which)
     }
 }
 
+//----------------------------------------------------------------------
+// SwitchThread
+// 	Yield the CPU "count" times, as fast as possible.
+//----------------------------------------------------------------------
+
+static const int NumBenchSwitches = 10000;
+
+static void
+SwitchThread(int count)
+{
+    for (int i = 0; i < count; i++) {
+        kernel->currentThread->Yield();
+    }
+}
+
+//----------------------------------------------------------------------
+// SwitchBenchmark
+// 	Measure how long a context switch takes the simulator, in host
+//	time, by ping-ponging between two threads.  The scheduler log is
+//	turned off meanwhile; writing it would swamp what is measured.
+//----------------------------------------------------------------------
+
+static void
+SwitchBenchmark()
+{
+    Thread *t = new Thread("switch thread", 2);
+    int switches = kernel->stats->numContextSwitches;
+    streambuf *log = cout.rdbuf(NULL);
+    double start, elapsed;
+
+    t->Fork((VoidFunctionPtr) SwitchThread, (void *) NumBenchSwitches);
+    start = HostMicroseconds();
+    SwitchThread(NumBenchSwitches);
+    elapsed = HostMicroseconds() - start;
+    switches = kernel->stats->numContextSwitches - switches;
+    kernel->currentThread->Yield();		// let it finish
+    cout.rdbuf(log);
+    cout.clear();
+
+    cout << "Context switch: " << switches << " switches, ";
+    cout << (switches == 0 ? 0.0 : elapsed * 1000.0 / switches);
+    cout << " ns each\n";
+}
+
+//----------------------------------------------------------------------
+// ScheduleBenchmark
+// 	Measure how long a scheduling decision takes the simulator, in
+//	host time, with "count" threads ready, spread over all three
+//	queues.  The threads are never forked: each decision just takes
+//	the next thread out of the ready queues and puts it back.  The
+//	policy is asked directly, so that nothing preempts the current
+//	thread.
+//----------------------------------------------------------------------
+
+static char benchName[] = "ready thread";
+
+static void
+ScheduleBenchmark(int count)
+{
+    SchedulingPolicy *policy = kernel->scheduler->Policy();
+    List<Thread *> others;
+    IntStatus oldLevel = kernel->interrupt->SetLevel(IntOff);
+    streambuf *log = cout.rdbuf(NULL);
+    double start, elapsed;
+
+    for (int i = 0; i < count; i++) {
+        Thread *t = new Thread(benchName, kernel->NewThreadID(), i % 150);
+
+        t->setBurstTime((i * 37) % 1000);
+        policy->Insert(t);
+    }
+    start = HostMicroseconds();
+    for (int i = 0; i < NumBenchSwitches; i++) {
+        policy->Insert(policy->RemoveNext());
+    }
+    elapsed = HostMicroseconds() - start;
+    for (int left = count; left > 0; ) {	// other threads go back
+        Thread *t = policy->RemoveNext();
+
+        if (t->getName() == benchName) {
+            delete t;
+            left--;
+        } else {
+            others.Append(t);
+        }
+    }
+    while (!others.IsEmpty()) {
+        policy->Insert(others.RemoveFront());
+    }
+    cout.rdbuf(log);
+    cout.clear();
+    (void) kernel->interrupt->SetLevel(oldLevel);
+
+    cout << "Scheduling: " << count << " ready threads, ";
+    cout << elapsed * 1000.0 / NumBenchSwitches << " ns per decision\n";
+}
+
+//----------------------------------------------------------------------
+// SignalTest
+// 	Check that threads waiting on a condition variable wake up when
+//	it is signalled, even when each one preempts the signaller: the
+//	condition variable must not lose the wakeup to the switch.  That
+//	takes a policy that preempts, so the test runs on a scheduler of
+//	its own, with the fair policy, and the signaller charged with a
+//	lot of CPU time.
+//----------------------------------------------------------------------
+
+static Lock *signalLock;
+static Condition *signalCondition;
+static int numSignals, numWoken;
+
+static void
+SignalWaiter(int which)
+{
+    signalLock->Acquire();
+    while (numSignals == 0) {
+        signalCondition->Wait(signalLock);
+    }
+    numSignals--;
+    numWoken++;
+    signalLock->Release();
+}
+
+static void
+SignalTest()
+{
+    Scheduler *scheduler = kernel->scheduler;
+    Thread *current = kernel->currentThread;
+    double vruntime = current->getVruntime();
+    IntStatus oldLevel;
+
+    kernel->scheduler = new Scheduler(NewSchedulingPolicy("cfs"));
+    signalLock = new Lock("signal test");
+    signalCondition = new Condition("signal test");
+    numSignals = numWoken = 0;
+    for (int i = 0; i < 2; i++) {
+        Thread *t = new Thread("signal waiter", kernel->NewThreadID());
+
+        t->Fork((VoidFunctionPtr) SignalWaiter, (void *) i);
+    }
+    current->Yield();				// both start waiting
+    current->setVruntime(vruntime + FairLatency * FairNiceWeight);
+
+    signalLock->Acquire();			// wake one...
+    numSignals++;
+    signalCondition->Signal(signalLock);
+    signalLock->Release();
+    for (int i = 0; i < 5; i++) {
+        current->Yield();
+    }
+    ASSERT(numWoken == 1);
+
+    signalLock->Acquire();			// ... and the other
+    numSignals++;
+    signalCondition->Broadcast(signalLock);
+    signalLock->Release();
+    for (int i = 0; i < 5; i++) {
+        current->Yield();
+    }
+    ASSERT(numWoken == 2);
+
+    oldLevel = kernel->interrupt->SetLevel(IntOff);
+    ASSERT(kernel->scheduler->FindNextToRun() == NULL);
+    delete kernel->scheduler;
+    kernel->scheduler = scheduler;
+    (void) kernel->interrupt->SetLevel(oldLevel);
+    current->setVruntime(vruntime);
+    delete signalCondition;
+    delete signalLock;
+}
+
 //----------------------------------------------------------------------
 // Thread::SelfTest
 // 	Set up a ping-pong between two threads, by forking a thread
 //	to call SimpleThread, and then calling SimpleThread ourselves.
+//	Then check that condition variables work with a policy that
+//	preempts, and time a lot of switches, and scheduling decisions
+//	with more and more threads ready.
 //----------------------------------------------------------------------
 
 void
@@ -475,4 +653,10 @@ Thread::SelfTest()
     t->Fork((VoidFunctionPtr) SimpleThread, (void *) 1);
     kernel->currentThread->Yield();
     SimpleThread(0);
+
+    SignalTest();
+    SwitchBenchmark();
+    for (int count = 1000; count <= 8000; count *= 2) {
+        ScheduleBenchmark(count);
+    }
 }
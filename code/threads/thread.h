@@ -42,6 +42,7 @@
 #include "sysdep.h"
 #include "machine.h"
 #include "addrspace.h"
+#include "readyqueue.h"
 
 // CPU register state to be saved on context switch.
 // The x86 needs to save only a few registers,
@@ -61,6 +62,7 @@ const int StackSize = (8 * 1024);	// in words
 // Thread state
 enum ThreadStatus { JUST_CREATED, RUNNING, READY, BLOCKED, ZOMBIE };
 
+class RealTimeTask;		// see schedpolicy.h
 
 // The following class defines a "thread control block" -- which
 // represents a single thread of execution.
@@ -85,6 +87,15 @@ class Thread {
     int startTime;
     int priority;
     int startWaitTime;
+    unsigned int readyOrder;	// when it was put in its ready queue
+    double vruntime;		// weighted CPU time, for FairPolicy
+    RealTimeTask *realTime;	// its period and budget, NULL if it
+				// is not real-time
+    Thread *agingPrev;		// neighbours in the scheduler's
+    Thread *agingNext;		// AgingQueue
+    friend class AgingQueue;
+    FairNode fairNode;		// its node when in a FairQueue
+    friend class FairQueue;
 
 
   public:
@@ -94,11 +105,17 @@ class Thread {
     double getBurstTime(){ return burstTime; }
     int getPriority(){ return priority; }
     int getStartWaitTime() { return startWaitTime; }
+    unsigned int getReadyOrder() { return readyOrder; }
+    double getVruntime() { return vruntime; }
+    RealTimeTask *getRealTime() { return realTime; }
 
     void setStartTime(int s){ startTime = s; }
     void setBurstTime(double s){ burstTime = s; }
     void setPriority(int s){ priority = s; }
     void setStartWaitTime(int s){ startWaitTime = s; }
+    void setReadyOrder(unsigned int s){ readyOrder = s; }
+    void setVruntime(double s){ vruntime = s; }
+    void setRealTime(RealTimeTask *s){ realTime = s; }
 
     Thread(char* debugName, int threadID);		// initialize a Thread
     Thread(char* threadName, int threadID, int priority);
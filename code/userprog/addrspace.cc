@@ -21,6 +21,17 @@
 #include "addrspace.h"
 #include "machine.h"
 #include "noff.h"
+#include "frametable.h"
+#include "invertedtable.h"
+#include "swap.h"
+#include "compresscache.h"
+#include "synch.h"
+#include "sharedmem.h"
+#include "uthread.h"
+#include "asyncio.h"
+
+static int nextSpaceId = 0;		// for naming address spaces
+static int nextTlbVictim = 0;		// TLB entry to replace next
 
 //----------------------------------------------------------------------
 // SwapHeader
@@ -68,6 +79,25 @@ SwapHeader (NoffHeader *noffH)
 
 AddrSpace::AddrSpace()
 {
+    pageTable = NULL;			// set up by Load
+    numPages = 0;
+    numLarge = 0;
+    spaceId = nextSpaceId++;
+    stackBase = MaxVirtPages;
+    heapBreak = 0;
+    swapFirst = -1;			// not demand paged
+    prefetched = NULL;
+    faultAround = 0;
+    nextFault = -1;
+    pid = -1;
+    ring = -1;
+    pipeEnds = new List<int>;
+    faultLock = new Lock("page fault");
+    asyncIO = NULL;
+    userThreads = NULL;
+    for (int i = 0; i < MaxMappings; i++)
+        mapping[i].numPages = 0;
+
     // pageTable = new TranslationEntry[NumPhysPages];
     // for (int i = 0; i < NumPhysPages; i++) {
 	// pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
@@ -89,10 +119,65 @@ AddrSpace::AddrSpace()
 
 AddrSpace::~AddrSpace()
 {
-    for(int i=0 ; i<numPages ; i++)
-        if(pageTable[i].valid)
-            kernel->freeFrameList->Append(pageTable[i].physicalPage);
-    delete pageTable;
+    int *frames = new int[NumPhysPages];
+    int numFrames = 0;
+
+    if (asyncIO != NULL)		// finish any queued writes
+        delete asyncIO;
+    delete pipeEnds;
+    delete faultLock;
+    if (userThreads != NULL)		// they have all exited
+        delete userThreads;
+    for (int i = 0; i < MaxMappings; i++) {
+        if (mapping[i].numPages == 0)
+            continue;
+        if (mapping[i].segment != -1)	// the frames aren't ours
+            ShmDetach(mapping[i].firstPage * PageSize);
+        else				// write back modified pages
+            Munmap(mapping[i].firstPage * PageSize);
+    }
+    if (swapFirst != -1) {
+        unsigned int numSlots = numPages + (MaxVirtPages - stackBase);
+
+        for (unsigned int slot = 0; slot < numSlots; slot++) {
+            if (!prefetched->Test(slot))
+                continue;
+            int vpn = (slot < numPages) ? slot : stackBase + slot - numPages;
+            SyncTlb(vpn, FALSE);
+            if (FindPage(vpn)->use)	// referenced, but the clock
+                kernel->stats->numPrefetchUseful++;	// didn't notice
+            else
+                kernel->stats->numPrefetchWasted++;
+        }
+        delete prefetched;
+        if (kernel->compressedCache != NULL)
+            kernel->compressedCache->Invalidate(swapFirst, numSlots);
+        kernel->swapSpace->Free(swapFirst, numSlots);
+    }
+
+    if (kernel->invertedTable != NULL) {
+        numFrames = kernel->invertedTable->UnmapSpace(spaceId, frames);
+        kernel->frameTable->Free(numFrames, frames);
+    } else if (pageTable != NULL) {
+        for (int dir = 0; dir < PageDirEntries; dir++) {
+            TranslationEntry *table = pageTable->Table(dir);
+            if (table == NULL)
+                continue;		// nothing mapped in this range
+            for (int i = 0; i < PageTableEntries; i++) {
+                if (!table[i].valid)
+                    continue;
+                if (table[i].large)	// a run of its own
+                    kernel->frameTable->FreeContiguous(table[i].physicalPage,
+                                LargePageRatio);
+                else
+                    frames[numFrames++] = table[i].physicalPage;
+            }
+        }
+        kernel->frameTable->Free(numFrames, frames);	// one batch
+        delete pageTable;
+    }
+    delete [] frames;
+    kernel->scheduler->ForgetSpace(this);	// nothing left to save
 }
 
 
@@ -100,8 +185,11 @@ AddrSpace::~AddrSpace()
 // AddrSpace::Load
 // 	Load a user program into memory from a file.
 //
-//	Assumes that the page table has been initialized, and that
-//	the object code file is in NOFF format.
+//	The code and data go at the bottom of the virtual address space,
+//	and the stack at the very top, leaving the range in between
+//	unmapped; only the pages actually used get page table entries.
+//
+//	Assumes that the object code file is in NOFF format.
 //
 //	"fileName" is the file containing the object code to load into memory
 //----------------------------------------------------------------------
@@ -111,7 +199,7 @@ AddrSpace::Load(char *fileName)
 {
     OpenFile *executable = kernel->fileSystem->Open(fileName);
     NoffHeader noffH;
-    unsigned int size;
+    unsigned int size, stackPages;
 
     if (executable == NULL) {
 	cerr << "Unable to open file " << fileName << "\n";
@@ -125,65 +213,62 @@ AddrSpace::Load(char *fileName)
     ASSERT(noffH.noffMagic == NOFFMAGIC);
 
 #ifdef RDATA
-// how big is address space?
+// how big is the program image?
     size = noffH.code.size + noffH.readonlyData.size + noffH.initData.size +
-           noffH.uninitData.size + UserStackSize;
-                                                // we need to increase the size
-						// to leave room for the stack
+           noffH.uninitData.size;
 #else
-// how big is address space?
-    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size
-			+ UserStackSize;	// we need to increase the size
-						// to leave room for the stack
+// how big is the program image?
+    size = noffH.code.size + noffH.initData.size + noffH.uninitData.size;
 #endif
     numPages = divRoundUp(size, PageSize);
-    size = numPages * PageSize;
+    stackPages = divRoundUp(UserStackSize, PageSize);
+    ASSERT(numPages + stackPages <= MaxVirtPages);
 
-    ASSERT(numPages <= kernel->freeFrameList->NumInList());		// check we're not trying
-						// to run anything too big --
-						// at least until we have
-						// virtual memory
+    DEBUG(dbgAddr, "Initializing address space: " << numPages << " + "
+			<< stackPages << " stack pages");
 
-    DEBUG(dbgAddr, "Initializing address space: " << numPages << ", " << size);
+    stackBase = MaxVirtPages - stackPages;
+    heapBreak = numPages * PageSize;	// empty heap, right after the image
+    if (kernel->invertedTable == NULL)
+        pageTable = new PageTable();
 
-    pageTable = new TranslationEntry[numPages];
-    for (int i = 0; i < numPages ; i++) {
-    int freeFrame = kernel->freeFrameList->Front();
-    kernel->freeFrameList->RemoveFront();
-    pageTable[i].virtualPage = i;	// for now, virt page # = phys page #
-    pageTable[i].physicalPage = freeFrame;
-    pageTable[i].valid = TRUE;
-    pageTable[i].use = FALSE;
-    pageTable[i].dirty = FALSE;
-    pageTable[i].readOnly = FALSE;
-    // zero out
-    //bzero((void*)(kernel->machine->mainMemory[freeFrame*PageSize]), PageSize);
+    char *image = NULL;
+    if (kernel->swapSpace != NULL) {
+        // demand paging: nothing goes into memory yet.  The image is
+        // put together in a buffer, and written to swap in one request
+        swapFirst = kernel->swapSpace->Allocate(numPages + stackPages);
+        if (swapFirst == -1) {
+            cerr << "Not enough swap space to run " << fileName << "\n";
+            delete executable;
+            numPages = 0;
+            return FALSE;
+        }
+        image = new char[(numPages + stackPages) * PageSize];
+        bzero(image, (numPages + stackPages) * PageSize);
+        prefetched = new Bitmap(numPages + stackPages);
+    } else if (!MapImage(stackPages)) {
+        cerr << "Not enough memory to run " << fileName << "\n";
+        delete executable;
+        numPages = 0;
+        return FALSE;
     }
 
+    if (pageTable != NULL) {
+        DEBUG(dbgAddr, "Page table uses " << pageTable->NumTables() << " second-level tables");
+    }
 
-
-// then, copy in the code and data segments into memory
-// Note: this code assumes that virtual address = physical address
+// then, copy in the code and data segments into memory, a page
+// at a time, since the frames backing them need not be contiguous
     if (noffH.code.size > 0) {
         DEBUG(dbgAddr, "Initializing code segment.");
 	    DEBUG(dbgAddr, noffH.code.virtualAddr << ", " << noffH.code.size);
-
-        unsigned int paddr;
-        AddrSpace::Translate( noffH.code.virtualAddr, &paddr, 0);
-
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[paddr]),
+        LoadSegment(executable, image, noffH.code.virtualAddr,
 			noffH.code.size, noffH.code.inFileAddr);
     }
     if (noffH.initData.size > 0) {
         DEBUG(dbgAddr, "Initializing data segment.");
 	    DEBUG(dbgAddr, noffH.initData.virtualAddr << ", " << noffH.initData.size);
-
-        unsigned int paddr;
-        AddrSpace::Translate( noffH.code.virtualAddr, &paddr, 0);
-
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[paddr]),
+        LoadSegment(executable, image, noffH.initData.virtualAddr,
 			noffH.initData.size, noffH.initData.inFileAddr);
     }
 
@@ -191,16 +276,110 @@ AddrSpace::Load(char *fileName)
     if (noffH.readonlyData.size > 0) {
         DEBUG(dbgAddr, "Initializing read only data segment.");
 	    DEBUG(dbgAddr, noffH.readonlyData.virtualAddr << ", " << noffH.readonlyData.size);
-        executable->ReadAt(
-		&(kernel->machine->mainMemory[noffH.readonlyData.virtualAddr]),
+        LoadSegment(executable, image, noffH.readonlyData.virtualAddr,
 			noffH.readonlyData.size, noffH.readonlyData.inFileAddr);
     }
 #endif
 
+    if (image != NULL) {
+        kernel->swapSpace->WritePages(swapFirst, numPages + stackPages, image);
+        delete [] image;
+    }
+
     delete executable;			// close file
     return TRUE;			// success
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::MapImage
+// 	Allocate frames for the whole program image and the stack, and
+//	map them, for address spaces that are not demand paged.
+//
+//	Returns FALSE, with nothing allocated, if memory is too full.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::MapImage(unsigned int stackPages)
+{
+    // with -lp, the image is mapped with large pages as far as it
+    // fills them, and as long as aligned runs of frames can be found
+    // (the inverted page table only knows about small pages)
+    numLarge = 0;
+    if (kernel->largePages && pageTable != NULL) {
+        while (numLarge < (int) (numPages / LargePageRatio)) {
+            int first = kernel->frameTable->AllocateContiguous(LargePageRatio,
+                                LargePageRatio);
+            if (first == -1)
+                break;			// too fragmented, use small pages
+            for (int f = first; f < first + LargePageRatio; f++)
+                kernel->frameTable->ZeroFill(f);
+            pageTable->MapLarge(numLarge * LargePageRatio, first, FALSE);
+            numLarge++;
+        }
+        DEBUG(dbgAddr, "Mapped " << numLarge << " large pages");
+    }
+
+    // MP2 grab all the other frames we need in one batch
+    int small = numPages - numLarge * LargePageRatio;
+    int *frames = new int[small + stackPages];
+    if (!kernel->frameTable->Allocate(small + stackPages, frames)) {
+        for (int i = 0; i < numLarge; i++) {
+            TranslationEntry *entry = pageTable->Lookup(i * LargePageRatio);
+            kernel->frameTable->FreeContiguous(entry->physicalPage,
+                                LargePageRatio);
+            pageTable->Unmap(i * LargePageRatio);
+        }
+        delete [] frames;
+        numLarge = 0;
+        return FALSE;
+    }
+
+    for (unsigned int i = 0; i < small + stackPages; i++)
+        kernel->frameTable->ZeroFill(frames[i]);	// uninitialized data
+							// and stack start zero
+    for (int i = 0; i < small; i++)
+        MapPage(numLarge * LargePageRatio + i, frames[i], FALSE);
+    // stack grows down from the top
+    for (unsigned int i = 0; i < stackPages; i++)
+        MapPage(stackBase + i, frames[small + i], FALSE);
+    delete [] frames;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::LoadSegment
+// 	Copy "size" bytes at offset "inFileAddr" of "executable" into
+//	this address space, starting at virtual address "virtualAddr".
+//	Consecutive virtual pages may live in unrelated physical frames,
+//	so the copy is done one page at a time.
+//
+//	If "image" is not NULL, the address space is demand paged, and
+//	the bytes go to "image", a buffer holding the whole program image,
+//	instead.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::LoadSegment(OpenFile *executable, char *image, int virtualAddr,
+			int size, int inFileAddr)
+{
+    if (image != NULL) {
+        executable->ReadAt(&image[virtualAddr], size, inFileAddr);
+        return;
+    }
+    while (size > 0) {
+        unsigned int paddr;
+        int chunk = min(size, PageSize - virtualAddr % PageSize);
+
+        ExceptionType ex = Translate(virtualAddr, &paddr, 0);
+        ASSERT(ex == NoException);
+        executable->ReadAt(&(kernel->machine->mainMemory[paddr]),
+			chunk, inFileAddr);
+        virtualAddr += chunk;
+        inFileAddr += chunk;
+        size -= chunk;
+    }
+}
+
 //----------------------------------------------------------------------
 // AddrSpace::Execute
 // 	Run a user program using the current thread
@@ -216,8 +395,9 @@ AddrSpace::Execute(char* fileName)
 
     kernel->currentThread->space = this;
 
+    kernel->scheduler->LoadUserState(kernel->currentThread);
+					// load page table register
     this->InitRegisters();		// set the initial register values
-    this->RestoreState();		// load page table register
 
     kernel->machine->Run();		// jump to the user progam
 
@@ -256,11 +436,11 @@ AddrSpace::InitRegisters()
     // after start will be at virtual address four.
     machine->WriteRegister(NextPCReg, 4);
 
-   // Set the stack register to the end of the address space, where we
+   // Set the stack register to the top of the address space, where we
    // allocated the stack; but subtract off a bit, to make sure we don't
    // accidentally reference off the end!
-    machine->WriteRegister(StackReg, numPages * PageSize - 16);
-    DEBUG(dbgAddr, "Initializing stack pointer: " << numPages * PageSize - 16);
+    machine->WriteRegister(StackReg, UserStackTop - 16);
+    DEBUG(dbgAddr, "Initializing stack pointer: " << UserStackTop - 16);
 }
 
 //----------------------------------------------------------------------
@@ -268,11 +448,25 @@ AddrSpace::InitRegisters()
 // 	On a context switch, save any machine state, specific
 //	to this address space, that needs saving.
 //
-//	For now, don't need to save anything!
+//	With a TLB, the use and dirty bits of the translations in it are
+//	copied back to the page table, since RestoreState will flush it.
 //----------------------------------------------------------------------
 
 void AddrSpace::SaveState()
-{}
+{
+    TranslationEntry *tlb = kernel->machine->tlb;
+
+    if (tlb == NULL)
+        return;
+    for (int i = 0; i < TLBSize; i++) {
+        if (tlb[i].valid) {
+            TranslationEntry *pte = FindPage(tlb[i].virtualPage);
+
+            pte->use |= tlb[i].use;
+            pte->dirty |= tlb[i].dirty;
+        }
+    }
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::RestoreState
@@ -284,10 +478,948 @@ void AddrSpace::SaveState()
 
 void AddrSpace::RestoreState()
 {
-    kernel->machine->pageTable = pageTable;
-    kernel->machine->pageTableSize = numPages;
+    Machine *machine = kernel->machine;
+
+    if (machine->tlb != NULL) {
+        // TLB entries don't say which address space they belong to,
+        // so they all go; PageFault reloads them on demand
+        for (int i = 0; i < TLBSize; i++)
+            machine->tlb[i].valid = FALSE;
+        return;
+    }
+    machine->pageTable = NULL;
+    machine->pageTableSize = 0;
+    if (kernel->invertedTable != NULL) {
+        machine->pageDirectory = NULL;
+        machine->invertedTable = kernel->invertedTable;
+        machine->spaceId = spaceId;
+    } else {
+        machine->pageDirectory = pageTable;
+        machine->invertedTable = NULL;
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::MapPage, AddrSpace::FindPage
+// 	Add the translation of virtual page "vpn" to "frame", or find
+//	the translation of "vpn" (NULL if there is none).  All address
+//	spaces share the kernel's inverted page table if there is one;
+//	otherwise each has its own two-level table.
+//----------------------------------------------------------------------
+
+TranslationEntry *
+AddrSpace::MapPage(unsigned int vpn, int frame, bool readOnly)
+{
+    if (kernel->invertedTable != NULL)
+        return kernel->invertedTable->Map(spaceId, vpn, frame, readOnly);
+    return pageTable->Map(vpn, frame, readOnly);
+}
+
+TranslationEntry *
+AddrSpace::FindPage(unsigned int vpn)
+{
+    if (kernel->invertedTable != NULL)
+        return kernel->invertedTable->Lookup(spaceId, vpn);
+    return pageTable->Lookup(vpn);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::UserRun
+// 	Find user virtual address "vaddr" in physical memory, for a
+//	system call that wants to read (or if "writing", write) "size"
+//	bytes there.  The page is faulted in if needed.
+//
+//	Returns a kernel pointer to the first byte, and in "*length" how
+//	many of the "size" bytes can be accessed through it: the rest of
+//	the page, plus any following pages that happen to be in the next
+//	frames (always the case within a large page).  So a system call
+//	can work directly on user memory, one contiguous run at a time,
+//	and a buffer in contiguous frames takes a single run.
+//
+//	Returns NULL if "vaddr" is not a valid address.
+//----------------------------------------------------------------------
+
+char *
+AddrSpace::UserRun(int vaddr, int size, bool writing, int *length)
+{
+    unsigned int paddr, next;
+    ExceptionType ex = Translate(vaddr, &paddr, writing);
+
+    if (ex == PageFaultException && PageFault(vaddr))
+        ex = Translate(vaddr, &paddr, writing);
+    if (ex != NoException)
+        return NULL;
+
+    // only pages already in memory extend the run: faulting one in
+    // could evict a page earlier in the run
+    *length = min(size, PageSize - vaddr % PageSize);
+    while (*length < size &&
+            Translate(vaddr + *length, &next, writing) == NoException &&
+            next == paddr + *length)
+        *length += min(size - *length, PageSize);
+    return &(kernel->machine->mainMemory[paddr]);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyIn, AddrSpace::CopyOut
+// 	Copy "size" bytes from user virtual address "vaddr" into kernel
+//	buffer "buffer", or the other way, a contiguous run at a time.
+//
+//	Returns the number of bytes copied, which is less than "size"
+//	if part of the user buffer is not a valid address; or -1 if none
+//	of it is.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::CopyIn(int vaddr, char *buffer, int size)
+{
+    int done = 0, length;
+
+    while (done < size) {
+        char *from = UserRun(vaddr + done, size - done, FALSE, &length);
+
+        if (from == NULL)
+            break;
+        bcopy(from, buffer + done, length);
+        done += length;
+    }
+    return (done == 0 && size > 0) ? -1 : done;
+}
+
+int
+AddrSpace::CopyOut(int vaddr, char *buffer, int size)
+{
+    int done = 0, length;
+
+    while (done < size) {
+        char *to = UserRun(vaddr + done, size - done, TRUE, &length);
+
+        if (to == NULL)
+            break;
+        bcopy(buffer + done, to, length);
+        done += length;
+    }
+    return (done == 0 && size > 0) ? -1 : done;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CopyInString
+// 	Copy the null-terminated string at user virtual address "vaddr"
+//	into "buffer", which holds "maxLength" bytes.
+//
+//	Returns the length of the string, or -1 if part of it is not a
+//	valid address, or if it doesn't fit.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::CopyInString(int vaddr, char *buffer, int maxLength)
+{
+    int done = 0, length;
+
+    while (done < maxLength) {
+        char *from = UserRun(vaddr + done, maxLength - done, FALSE, &length);
+        char *end;
+
+        if (from == NULL)
+            return -1;
+        end = (char *) memchr(from, '\0', length);
+        if (end != NULL) {		// found the end of the string
+            bcopy(from, buffer + done, end - from + 1);
+            return done + (end - from);
+        }
+        bcopy(from, buffer + done, length);
+        done += length;
+    }
+    return -1;				// too long
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::AsyncRequests
+// 	Return the asynchronous I/O requests of this address space.  The
+//	worker thread that does them is only started the first time a
+//	program uses asynchronous I/O, at the priority of its thread.
+//----------------------------------------------------------------------
+
+AsyncIO *
+AddrSpace::AsyncRequests()
+{
+    if (asyncIO == NULL)
+        asyncIO = new AsyncIO(kernel->currentThread->getPriority());
+    return asyncIO;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageFault
+// 	Called when the machine raises PageFaultException for virtual
+//	address "vaddr".  If the page is in the address space but not in
+//	memory, page it in (see PageIn).  With a TLB, this is usually
+//	just a TLB miss: find the translation in the page table and load
+//	it into the TLB, replacing entries round robin.  The use and
+//	dirty bits of the entry being replaced are copied back to the
+//	page table.
+//
+//	Paging in may wait for a frame, or for the disk.  The threads of
+//	a program share its address space, so they take their faults one
+//	at a time: otherwise two threads faulting on the same page would
+//	both page it in.  A thread that waited finds the page in memory.
+//
+//	Returns TRUE if the faulting instruction can be retried, FALSE
+//	if "vaddr" isn't part of the address space.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageFault(unsigned int vaddr)
+{
+    Machine *machine = kernel->machine;
+    unsigned int vpn = vaddr / PageSize;
+    TranslationEntry *pte, *victim;
+
+    if (vpn >= MaxVirtPages)
+        return FALSE;
+    pte = FindPage(vpn);
+    if (pte == NULL || !pte->valid) {
+        faultLock->Acquire();
+        if (!PageInFault(vpn)) {
+            faultLock->Release();
+            return FALSE;
+        }
+        pte = FindPage(vpn);
+        faultLock->Release();
+    }
+    if (machine->tlb == NULL)
+        return TRUE;
+
+    victim = &machine->tlb[nextTlbVictim];
+    nextTlbVictim = (nextTlbVictim + 1) % TLBSize;
+    if (victim->valid) {
+        TranslationEntry *old = FindPage(victim->virtualPage);
+
+        ASSERT(old != NULL);
+        old->use |= victim->use;
+        old->dirty |= victim->dirty;
+    }
+    *victim = *pte;
+    DEBUG(dbgAddr, "TLB refill of virtual page " << vpn << " -> " << pte->physicalPage);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageInFault
+// 	Bring page "vpn" into memory for a fault, from wherever it comes
+//	from, unless another thread of the program already has.  Called
+//	with the fault lock held.
+//
+//	Returns FALSE if "vpn" isn't part of the address space, or there
+//	is no memory for it.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageInFault(unsigned int vpn)
+{
+    TranslationEntry *pte = FindPage(vpn);
+    Mapping *m = FindMapping(vpn);
+
+    if (pte != NULL && pte->valid)
+        return TRUE;			// paged in while we waited
+    if (m != NULL) {
+        if (m->segment != -1 || !FilePageIn(m, vpn))
+            return FALSE;		// out of memory
+    } else if (vpn >= numPages && vpn < divRoundUp(heapBreak, PageSize)) {
+        if (!HeapPageIn(vpn))
+            return FALSE;
+    } else if (vpn >= ThreadStacksBase() && vpn < stackBase) {
+        if ((vpn - ThreadStacksBase()) % (ThreadStackPages + 1) == 0
+                || !HeapPageIn(vpn))
+            return FALSE;		// guard page, or out of memory
+    } else if (swapFirst == -1 || SwapSlot(vpn) == -1) {
+        return FALSE;			// not ours, or not paged
+    } else if (!PageIn(vpn)) {
+        return FALSE;			// out of memory
+    }
+    kernel->stats->numPageFaults++;
+    return TRUE;
 }
 
+//----------------------------------------------------------------------
+// AddrSpace::SwapSlot
+// 	Return which of this address space's swap slots backs virtual
+//	page "vpn": the image pages come first, then the stack pages.
+//	Returns -1 if "vpn" is in neither.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::SwapSlot(unsigned int vpn)
+{
+    if (vpn < numPages)
+        return vpn;
+    if (vpn >= stackBase && vpn < MaxVirtPages)
+        return numPages + (vpn - stackBase);
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// GetFrame
+// 	Return a physical frame for a page being paged in, taking one
+//	away from some address space if memory is full.
+//
+//	Replacement uses the clock algorithm over all pageable frames: a
+//	page that was referenced since the hand last passed gets a second
+//	chance, otherwise it is paged out.  Frames without an owner (being
+//	paged in or out, or not pageable) are skipped.
+//
+//	Returns -1 if no frame can be found without demand paging, where
+//	only pages of mapped files are pageable; with demand paging, it
+//	waits for a frame instead, unless no frame at all is pageable:
+//	if heap and other pinned pages fill memory, none may ever be.
+//----------------------------------------------------------------------
+
+static int clockHand = 0;		// next frame to consider
+
+static int
+GetFrame()
+{
+    FrameTable *frames = kernel->frameTable;
+    int frame = frames->Allocate();
+
+    while (frame == -1) {
+        bool pageable = FALSE;
+
+        // two sweeps: the first may only clear use bits
+        for (int n = 0; n < 2 * NumPhysPages && frame == -1; n++) {
+            AddrSpace *space = frames->Owner(clockHand);
+            int vpn = frames->OwnerPage(clockHand);
+
+            if (space != NULL) {
+                pageable = TRUE;
+                if (!space->Referenced(vpn))
+                    frame = space->PageOut(vpn);
+            }
+            clockHand = (clockHand + 1) % NumPhysPages;
+        }
+        if (frame == -1) {		// everything is busy, wait
+            if (kernel->swapSpace == NULL || !pageable)
+                return -1;		// or give up, if it may never end
+            kernel->currentThread->Yield();
+            frame = frames->Allocate();
+        }
+    }
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageIn
+// 	Bring virtual page "vpn" in from swap, together with up to
+//	"faultAround" of the pages after it (fault-around).  All of them
+//	are read with one disk request, since their slots are adjacent.
+//
+//	The window adapts to the fault pattern: a fault on the page right
+//	after the previous batch means the program is scanning memory
+//	sequentially, so the window doubles, up to MaxFaultAround;
+//	any other fault resets it to zero.  Prefetched pages that turn
+//	out to be wasted halve it (see PageOut).
+//
+//	Prefetching is opportunistic: it stops at the first page that is
+//	already in memory or outside the segment, and only uses frames
+//	that are free -- it never pages anything out.
+//
+//	A page found in the compressed cache is just decompressed, with
+//	no disk request and no prefetching.
+//
+//	Returns FALSE if there is no frame for it.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::PageIn(unsigned int vpn)
+{
+    int slot = SwapSlot(vpn);
+    CompressedCache *cache = kernel->compressedCache;
+    int frames[MaxFaultAround + 1];
+    int count;
+    char *buffer;
+
+    if ((int) vpn == nextFault)
+        faultAround = min(max(2 * faultAround, 1), MaxFaultAround);
+    else
+        faultAround = 0;
+
+    frames[0] = GetFrame();
+    if (frames[0] == -1)
+        return FALSE;
+    if (cache != NULL) {		// cheap to get, no need to prefetch
+        bool dirty;
+        char *into = &(kernel->machine->mainMemory[frames[0] * PageSize]);
+
+        if (cache->Load(swapFirst + slot, into, &dirty)) {
+            MapPage(vpn, frames[0], FALSE)->dirty = dirty;
+            kernel->frameTable->SetOwner(frames[0], this, vpn);
+            nextFault = vpn + 1;
+            return TRUE;
+        }
+    }
+    for (count = 1; count <= faultAround; count++) {
+        TranslationEntry *pte = FindPage(vpn + count);
+
+        if (SwapSlot(vpn + count) != slot + count ||
+                (pte != NULL && pte->valid))
+            break;			// end of segment, or already in
+        if (cache != NULL && cache->Contains(swapFirst + slot + count))
+            break;			// disk copy may be out of date
+        frames[count] = kernel->frameTable->Allocate();
+        if (frames[count] == -1)
+            break;			// don't page out for a guess
+    }
+    nextFault = vpn + count;
+
+    DEBUG(dbgAddr, "Page in " << vpn << ", " << count - 1 << " more pages");
+    buffer = new char[count * PageSize];
+    kernel->swapSpace->ReadPages(swapFirst + slot, count, buffer);
+    for (int i = 0; i < count; i++) {
+        bcopy(&buffer[i * PageSize],
+                &(kernel->machine->mainMemory[frames[i] * PageSize]), PageSize);
+        MapPage(vpn + i, frames[i], FALSE);
+        kernel->frameTable->SetOwner(frames[i], this, vpn + i);
+        if (i > 0)
+            prefetched->Mark(slot + i);
+    }
+    delete [] buffer;
+    kernel->stats->numPagesPrefetched += count - 1;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Referenced
+// 	Clock algorithm helper: return whether virtual page "vpn" has
+//	been referenced since the last call, clearing its use bit.
+//	A prefetched page found referenced is counted as useful.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::Referenced(unsigned int vpn)
+{
+    TranslationEntry *pte = FindPage(vpn);
+    int slot = SwapSlot(vpn);
+
+    SyncTlb(vpn, FALSE);
+    if (!pte->use)
+        return FALSE;
+    pte->use = FALSE;
+    if (slot != -1 && prefetched->Test(slot)) {
+        prefetched->Clear(slot);
+        kernel->stats->numPrefetchUseful++;
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PageOut
+// 	Take virtual page "vpn" out of memory, writing it back to its
+//	swap slot if it was modified, and return the frame it used.
+//	The frame stays allocated, for the caller to reuse.
+//
+//	A prefetched page leaving memory without ever being referenced
+//	was a wasted prefetch, so the fault-around window shrinks.
+//
+//	A page of a mapped file goes back to the file instead.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::PageOut(unsigned int vpn)
+{
+    TranslationEntry *pte = FindPage(vpn);
+    int slot = SwapSlot(vpn);
+    int frame = pte->physicalPage;
+    Mapping *m = FindMapping(vpn);
+    bool dirty;
+
+    SyncTlb(vpn, TRUE);
+    dirty = pte->dirty;
+    if (m != NULL) {
+        UnmapPage(vpn, frame);
+        FilePageOut(m, vpn, frame, dirty);
+        return frame;
+    }
+    if (prefetched->Test(slot)) {
+        prefetched->Clear(slot);
+        kernel->stats->numPrefetchWasted++;
+        faultAround /= 2;
+    }
+
+    // unmap first, so nobody else finds the page while it is written
+    UnmapPage(vpn, frame);
+
+    DEBUG(dbgAddr, "Page out " << vpn << " from frame " << frame
+                << (dirty ? ", dirty" : ""));
+    char *page = &(kernel->machine->mainMemory[frame * PageSize]);
+    if (kernel->compressedCache != NULL &&
+            kernel->compressedCache->Store(swapFirst + slot, page, dirty))
+        return frame;			// kept, compressed, in memory
+    if (dirty)
+        kernel->swapSpace->WritePages(swapFirst + slot, 1, page);
+    return frame;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::PreClean
+// 	Called when the machine is idle.  Look at the pages the clock
+//	hand will reach next: a dirty page that hasn't been referenced
+//	lately will likely be evicted soon, so start writing it back to
+//	swap now, while the disk has nothing else to do.  By the time it
+//	is evicted, it will be clean, and eviction won't have to wait
+//	for the disk.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::PreClean()
+{
+    FrameTable *frames = kernel->frameTable;
+
+    for (int n = 0; n < PreCleanAhead; n++) {
+        int frame = (clockHand + n) % NumPhysPages;
+        AddrSpace *space = frames->Owner(frame);
+
+        if (space != NULL && space->CleanRun(frames->OwnerPage(frame)))
+            return;			// the disk is busy now
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::CleanRun
+// 	Start writing back the dirty, unreferenced page "vpn", together
+//	with those right after it, with one write behind request.  Their
+//	dirty bits are cleared; a write from now on sets them again.
+//
+//	Returns FALSE if "vpn" doesn't need cleaning; TRUE if a write
+//	was started, or couldn't be since the disk is busy.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::CleanRun(unsigned int vpn)
+{
+    int slot = SwapSlot(vpn);
+    int count;
+    char *buffer;
+
+    if (slot == -1)
+        return FALSE;			// a mapped file, not swap
+    buffer = new char[MaxFaultAround * PageSize];
+
+    for (count = 0; count < MaxFaultAround; count++) {
+        TranslationEntry *pte = FindPage(vpn + count);
+
+        if (pte == NULL || !pte->valid || SwapSlot(vpn + count) != slot + count)
+            break;
+        SyncTlb(vpn + count, FALSE);
+        if (!pte->dirty || pte->use)
+            break;
+        bcopy(&(kernel->machine->mainMemory[pte->physicalPage * PageSize]),
+                &buffer[count * PageSize], PageSize);
+    }
+    if (count > 0 && kernel->swapSpace->WriteBehind(swapFirst + slot, count,
+                                buffer)) {
+        DEBUG(dbgAddr, "Pre-cleaning pages " << vpn << " .. " << vpn + count - 1);
+        for (int i = 0; i < count; i++)
+            FindPage(vpn + i)->dirty = FALSE;
+        kernel->stats->numPagesPreCleaned += count;
+    }
+    delete [] buffer;
+    return count > 0;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::SyncTlb
+// 	If this address space is loaded and the TLB holds a translation
+//	for "vpn", copy its use and dirty bits back to the page table,
+//	and if "invalidate", throw the TLB entry away.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::SyncTlb(unsigned int vpn, bool invalidate)
+{
+    TranslationEntry *tlb = kernel->machine->tlb;
+
+    if (tlb == NULL || kernel->scheduler->LoadedSpace() != this)
+        return;
+    for (int i = 0; i < TLBSize; i++) {
+        if (tlb[i].valid && tlb[i].virtualPage == (int) vpn) {
+            TranslationEntry *pte = FindPage(vpn);
+
+            pte->use |= tlb[i].use;
+            pte->dirty |= tlb[i].dirty;
+            tlb[i].use = tlb[i].dirty = FALSE;
+            if (invalidate)
+                tlb[i].valid = FALSE;
+        }
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::UnmapPage
+// 	Remove the translation of virtual page "vpn", which is in frame
+//	"frame", and forget that the frame holds it.  The frame stays
+//	allocated.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::UnmapPage(unsigned int vpn, int frame)
+{
+    if (kernel->invertedTable != NULL)
+        kernel->invertedTable->Unmap(frame);
+    else
+        pageTable->Unmap(vpn);
+    kernel->frameTable->SetOwner(frame, NULL, -1);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::NewMapping
+// 	Find an unused Mapping, and room for "count" virtual pages for
+//	it: the lowest free pages from MmapBase up.  Returns the mapping,
+//	with its pages set, or NULL if there is no mapping or no room.
+//----------------------------------------------------------------------
+
+Mapping *
+AddrSpace::NewMapping(int count)
+{
+    unsigned int first = MmapBase;
+    Mapping *m = NULL;
+
+    for (int i = 0; i < MaxMappings; i++) {
+        if (mapping[i].numPages == 0) {
+            m = &mapping[i];
+            break;
+        }
+    }
+    if (m == NULL)
+        return NULL;			// too many mappings
+
+    // first fit: move past every mapping in the way, until none is
+    for (int i = 0; i < MaxMappings; i++) {
+        Mapping *other = &mapping[i];
+
+        if (other->numPages > 0 && first < other->firstPage + other->numPages
+                && other->firstPage < first + count) {
+            first = other->firstPage + other->numPages;
+            i = -1;			// start over
+        }
+    }
+    if (first + count > ThreadStacksBase())
+        return NULL;
+    m->firstPage = first;
+    m->numPages = count;
+    return m;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Mmap
+// 	Map "length" bytes of open file "fileId", starting at position
+//	"offset", into this address space.  Nothing is read yet: each
+//	page is read from the file the first time it is referenced (see
+//	FilePageIn).
+//
+//	The mapping holds on to the file until it is unmapped: if the
+//	program closes it, the pages still go back to this file, not to
+//	the next one opened.
+//
+//	Returns the virtual address of the mapping, or 0 (which is never
+//	mapped) if the file isn't open, the arguments are bad, or there
+//	is no room.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Mmap(int fileId, int offset, int length)
+{
+    OpenFile *file = kernel->FindFile(fileId);
+    Mapping *m;
+
+    if (file == NULL || offset < 0 || length <= 0)
+        return 0;
+    m = NewMapping(divRoundUp(length, PageSize));
+    if (m == NULL)
+        return 0;
+    m->segment = -1;
+    m->file = file;
+    m->offset = offset;
+    m->length = length;
+    kernel->HoldFile(file);
+    DEBUG(dbgAddr, "Mapped " << length << " bytes of file " << fileId
+                << " at page " << m->firstPage);
+    return m->firstPage * PageSize;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Munmap
+// 	Remove the mapping starting at virtual address "vaddr", writing
+//	the pages that were modified back to the file, and freeing the
+//	frames of all its pages in memory.
+//
+//	Returns FALSE if no mapping starts at "vaddr".
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::Munmap(int vaddr)
+{
+    Mapping *m = FindMapping(vaddr / PageSize);
+
+    if (m == NULL || m->segment != -1 || vaddr != (int) (m->firstPage * PageSize))
+        return FALSE;
+    for (unsigned int vpn = m->firstPage; vpn < m->firstPage + m->numPages;
+                vpn++) {
+        TranslationEntry *pte = FindPage(vpn);
+        int frame;
+        bool dirty;
+
+        if (pte == NULL || !pte->valid)
+            continue;			// never referenced, or evicted
+        frame = pte->physicalPage;
+        SyncTlb(vpn, TRUE);
+        dirty = pte->dirty;		// before the entry goes away
+        UnmapPage(vpn, frame);
+        FilePageOut(m, vpn, frame, dirty);
+        kernel->frameTable->Free(frame);
+    }
+    kernel->ReleaseFile(m->file);
+    m->numPages = 0;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Sbrk
+// 	Move the end of the heap by "delta" bytes.  Growing the heap
+//	only moves the end: a new page gets a frame, zero filled, the
+//	first time it is referenced (see HeapPageIn), so a program that
+//	asks for more than it uses doesn't take frames for nothing.
+//	Shrinking it frees the frames of the pages no longer in it.
+//
+//	Returns the old end of the heap, or -1 if the heap would end
+//	before it starts, or run into the memory-mapped files.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::Sbrk(int delta)
+{
+    unsigned int oldBreak = heapBreak;
+    unsigned int newBreak = heapBreak + delta;
+
+    if ((delta < 0 && (unsigned int) -delta > heapBreak - numPages * PageSize)
+            || (delta > 0 && (unsigned int) delta > MmapBase * PageSize - heapBreak))
+        return -1;
+    FreePages(divRoundUp(newBreak, PageSize), divRoundUp(oldBreak, PageSize));
+    heapBreak = newBreak;
+    DEBUG(dbgAddr, "Heap ends at " << heapBreak);
+    return oldBreak;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FreePages
+// 	Unmap pages "first" up to (not including) "last", and free their
+//	frames.  The pages have no backing store, like heap pages, so
+//	their contents are lost.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::FreePages(unsigned int first, unsigned int last)
+{
+    for (unsigned int vpn = first; vpn < last; vpn++) {
+        TranslationEntry *pte = FindPage(vpn);
+        int frame;
+
+        if (pte == NULL || !pte->valid)
+            continue;			// never referenced
+        frame = pte->physicalPage;
+        SyncTlb(vpn, TRUE);
+        UnmapPage(vpn, frame);
+        kernel->frameTable->Free(frame);
+    }
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::HeapPageIn
+// 	Heap page "vpn" is referenced for the first time: map it to a
+//	frame, zero filled.  Heap pages have no backing store, so they
+//	stay in memory until the heap shrinks or the program exits.  So
+//	do the pages of thread stacks.
+//
+//	Returns FALSE if there is no frame for it.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::HeapPageIn(unsigned int vpn)
+{
+    int frame = GetFrame();
+
+    if (frame == -1)
+        return FALSE;
+    kernel->frameTable->ZeroFill(frame);
+    MapPage(vpn, frame, FALSE);
+    DEBUG(dbgAddr, "Heap page " << vpn << " in frame " << frame);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::Threads
+// 	Return the threads sharing this address space.  They are kept
+//	track of from the first ThreadFork on; until then, the thread
+//	running the program is the only one.
+//----------------------------------------------------------------------
+
+UserThreads *
+AddrSpace::Threads()
+{
+    if (userThreads == NULL)
+        userThreads = new UserThreads(this);
+    return userThreads;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ThreadStackTop, AddrSpace::FreeThreadStack
+// 	The stack of thread "id" (from 1 to MaxUserThreads - 1) is the
+//	id'th run of ThreadStackPages pages below the user stack, each
+//	with a guard page under it.  Its pages get frames when they are
+//	first referenced, and lose them when the thread is joined.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::ThreadStackTop(int id)
+{
+    unsigned int guard = ThreadStacksBase() + (id - 1) * (ThreadStackPages + 1);
+
+    return (guard + 1 + ThreadStackPages) * PageSize - 16;
+}
+
+void
+AddrSpace::FreeThreadStack(int id)
+{
+    unsigned int guard = ThreadStacksBase() + (id - 1) * (ThreadStackPages + 1);
+
+    FreePages(guard + 1, guard + 1 + ThreadStackPages);
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ShmAttach
+// 	Map shared memory segment "id" into this address space.  Its
+//	frames are already there, so they are all mapped at once; they
+//	stay pinned, since another address space may be using them.
+//	Shared memory doesn't work with the inverted page table, which
+//	maps each frame to a single page.
+//
+//	Returns the virtual address of the segment, or 0 on failure.
+//----------------------------------------------------------------------
+
+int
+AddrSpace::ShmAttach(int id)
+{
+    int count, *frames;
+    Mapping *m;
+
+    if (kernel->invertedTable != NULL)
+        return 0;
+    frames = kernel->sharedMemory->Attach(id, &count);
+    if (frames == NULL)
+        return 0;
+    m = NewMapping(count);
+    if (m == NULL) {
+        kernel->sharedMemory->Detach(id);
+        return 0;
+    }
+    m->segment = id;
+    for (int i = 0; i < count; i++)
+        MapPage(m->firstPage + i, frames[i], FALSE);
+    DEBUG(dbgAddr, "Attached shared segment " << id << " at page " << m->firstPage);
+    return m->firstPage * PageSize;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::ShmDetach
+// 	Unmap the shared memory segment attached at virtual address
+//	"vaddr".  Its frames are freed along with the segment, once no
+//	address space uses it.
+//
+//	Returns FALSE if no segment is attached at "vaddr".
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::ShmDetach(int vaddr)
+{
+    Mapping *m = FindMapping(vaddr / PageSize);
+
+    if (m == NULL || m->segment == -1 || vaddr != (int) (m->firstPage * PageSize))
+        return FALSE;
+    for (unsigned int vpn = m->firstPage; vpn < m->firstPage + m->numPages;
+                vpn++) {
+        SyncTlb(vpn, TRUE);
+        pageTable->Unmap(vpn);
+    }
+    kernel->sharedMemory->Detach(m->segment);
+    m->numPages = 0;
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FindMapping
+// 	Return the mapped file containing virtual page "vpn", or NULL.
+//----------------------------------------------------------------------
+
+Mapping *
+AddrSpace::FindMapping(unsigned int vpn)
+{
+    if (vpn < MmapBase || vpn >= ThreadStacksBase())
+        return NULL;			// the usual case
+    for (int i = 0; i < MaxMappings; i++) {
+        Mapping *m = &mapping[i];
+
+        if (m->numPages > 0 && vpn >= m->firstPage
+                && vpn < m->firstPage + m->numPages)
+            return m;
+    }
+    return NULL;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FilePageIn
+// 	Read virtual page "vpn" of mapped file "m" into a frame, straight
+//	from the file -- the file system finds its sectors -- and map it.
+//	The part of the page past the mapping, or past the end of the
+//	file, is zero.
+//
+//	Returns FALSE if there is no frame for it.
+//----------------------------------------------------------------------
+
+bool
+AddrSpace::FilePageIn(Mapping *m, unsigned int vpn)
+{
+    int frame = GetFrame();
+    int position = (vpn - m->firstPage) * PageSize;
+
+    if (frame == -1)
+        return FALSE;
+    kernel->frameTable->ZeroFill(frame);
+    m->file->ReadAt(&(kernel->machine->mainMemory[frame * PageSize]),
+                min(PageSize, m->length - position), m->offset + position);
+    DEBUG(dbgAddr, "Page in " << vpn << " from a mapped file");
+    MapPage(vpn, frame, FALSE);
+    kernel->frameTable->SetOwner(frame, this, vpn);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// AddrSpace::FilePageOut
+// 	Virtual page "vpn" of mapped file "m", in frame "frame", has been
+//	unmapped; if "dirty", write it back to the file.  Only the part
+//	of the page inside the mapping is written, so the file doesn't
+//	grow.  The file may have been closed since: the mapping still
+//	holds it.
+//----------------------------------------------------------------------
+
+void
+AddrSpace::FilePageOut(Mapping *m, unsigned int vpn, int frame, bool dirty)
+{
+    int position = (vpn - m->firstPage) * PageSize;
+
+    if (!dirty)
+        return;
+    DEBUG(dbgAddr, "Write back " << vpn << " to a mapped file");
+    m->file->WriteAt(&(kernel->machine->mainMemory[frame * PageSize]),
+                min(PageSize, m->length - position), m->offset + position);
+}
 
 //----------------------------------------------------------------------
 // AddrSpace::Translate
@@ -305,17 +1437,22 @@ AddrSpace::Translate(unsigned int vaddr, unsigned int *paddr, int isReadWrite)
     unsigned int      vpn    = vaddr / PageSize;
     unsigned int      offset = vaddr % PageSize;
 
-    if(vpn >= numPages) {
+    if(vpn >= MaxVirtPages) {
         return AddressErrorException;
     }
 
-    pte = &pageTable[vpn];
+    pte = FindPage(vpn);
+    if(pte == NULL || !pte->valid) {
+        return PageFaultException;
+    }
 
     if(isReadWrite && pte->readOnly) {
         return ReadOnlyException;
     }
 
     pfn = pte->physicalPage;
+    if (pte->large)
+        pfn += vpn - pte->virtualPage;
 
     // if the pageFrame is too big, there is something really wrong!
     // An invalid translation was loaded into the page table or TLB.
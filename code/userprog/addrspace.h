@@ -16,8 +16,49 @@
 #include "copyright.h"
 #include "filesys.h"
 #include "list.h"
+#include "pagetable.h"
+#include "bitmap.h"
+
+class AsyncIO;
+class UserThreads;
+class Lock;
 
 #define UserStackSize		1024 	// increase this as necessary!
+#define MaxFaultAround		8	// most pages read ahead of a fault
+#define PreCleanAhead		16	// frames ahead of the clock hand
+					// to clean when idle
+
+// The user stack sits at the very top of the virtual address space,
+// far away from the code and data at the bottom.  The heap grows up
+// from the end of the data, to at most the middle of the address space;
+// memory-mapped files go from the middle up.  Just below the user stack
+// are the stacks of the other threads of the program (see ThreadFork).
+// Each of these stacks, the user stack included, is above an unmapped
+// guard page.
+const unsigned int UserStackTop = MaxVirtPages * PageSize;
+const unsigned int MmapBase = MaxVirtPages / 2;	// first page for Mmap
+const int MaxMappings = 8;		// mapped files per address space
+const int MaxUserThreads = 8;		// threads per address space,
+					// the first one included
+const int ThreadStackPages = 8;		// stack of each other thread
+
+// A file mapped into an address space by Mmap.  Its pages are read
+// from the file on first reference, and written back to it when
+// they are evicted or unmapped, if they were modified.  Or, a shared
+// memory segment attached by ShmAttach, whose pages are always mapped.
+
+class Mapping {
+  public:
+    unsigned int firstPage;		// first virtual page
+    int numPages;			// 0 if this mapping is unused
+    int segment;			// shared memory segment, -1 if this
+					// maps a file
+    OpenFile *file;			// the file, kept open for the mapping
+					// even if it is closed (see
+					// Kernel::HoldFile)
+    int offset;				// position in the file of firstPage
+    int length;				// # of bytes of the file mapped
+};
 
 class AddrSpace {
   public:
@@ -41,15 +82,137 @@ class AddrSpace {
     // is 0 for Read, 1 for Write.
     ExceptionType Translate(unsigned int vaddr, unsigned int *paddr, int mode);
 
+    // Access to user memory for system calls.  Pages are faulted in
+    // as needed.  All return -1 (or NULL) on a bad address.
+    char *UserRun(int vaddr, int size, bool writing, int *length);
+					// Kernel pointer to "vaddr"; the
+					// first "*length" of the "size"
+					// bytes there are contiguous
+    int CopyIn(int vaddr, char *buffer, int size);
+    int CopyOut(int vaddr, char *buffer, int size);
+					// Copy "size" bytes from/to user
+					// memory, return the # copied
+    int CopyInString(int vaddr, char *buffer, int maxLength);
+					// Copy a null-terminated string
+					// of less than "maxLength" bytes,
+					// return its length
+
+    bool PageFault(unsigned int vaddr);	// Handle a page fault (or TLB
+					// miss) at "vaddr"; FALSE if the
+					// address isn't mapped at all
+
+    bool Referenced(unsigned int vpn);	// Test and clear the use bit
+    int PageOut(unsigned int vpn);	// Evict a page, return its frame
+    static void PreClean();		// Write back pages about to be
+					// evicted, while the disk is idle
+
+    void SetPid(int id) { pid = id; }
+    int Pid() { return pid; }		// Process this address space
+					// belongs to
+
+    void SetRing(int vaddr) { ring = vaddr; }
+    int Ring() { return ring; }		// Address of the registered
+					// system call ring, -1 if none
+    List<int> *PipeEnds() { return pipeEnds; }
+					// Ids of the pipe ends this program
+					// holds (see pipe.h)
+    AsyncIO *AsyncRequests();		// Asynchronous I/O of this space,
+					// set up on first use
+    bool HasAsyncRequests() { return asyncIO != NULL; }
+					// Has it been set up?
+
+    int Mmap(int fileId, int offset, int length);
+					// Map "length" bytes of a file,
+					// return their virtual address
+    bool Munmap(int vaddr);		// Unmap the mapping at "vaddr",
+					// writing modified pages back
+    int ShmAttach(int id);		// Map a shared memory segment,
+					// return its virtual address
+    bool ShmDetach(int vaddr);		// Unmap the segment at "vaddr"
+    int Sbrk(int delta);		// Grow (or shrink) the heap, return
+					// the old end of the heap
+
+    UserThreads *Threads();		// Threads sharing this space, set
+					// up on first use
+    bool MultiThreaded() { return userThreads != NULL; }
+    int ThreadStackTop(int id);		// Initial stack pointer of thread
+					// "id" (not the first thread)
+    void FreeThreadStack(int id);	// Give back its pages
+
   private:
-    TranslationEntry *pageTable;	// Assume linear page table translation
-					// for now!
-    unsigned int numPages;		// Number of pages in the virtual
-					// address space
+    PageTable *pageTable;		// Two-level, so that the address
+					// space can be sparse; NULL if the
+					// kernel's inverted table is used
+    int spaceId;			// Names this address space in the
+					// inverted page table
+    unsigned int numPages;		// Number of pages in the program
+					// image (code and data)
+    int numLarge;			// Number of large pages at the
+					// start of the image
+    unsigned int stackBase;		// First virtual page of the stack
+    unsigned int heapBreak;		// End of the heap (address); the
+					// heap starts at page numPages
+
+    // demand paging
+    int swapFirst;			// First of our swap slots, -1 if
+					// everything is loaded up front
+    Bitmap *prefetched;			// Slots paged in ahead of a fault,
+					// and not referenced yet
+    int faultAround;			// # of pages to read ahead
+    int nextFault;			// Page a sequential scan would
+					// fault on next
+
+    int pid;				// see process.h
+    int ring;				// see RegisterRing in syscall.h
+    List<int> *pipeEnds;		// closed by ProcessTable::Exit
+    Lock *faultLock;			// one page fault at a time, among
+					// the threads of the program
+    AsyncIO *asyncIO;			// NULL until the first AsyncRead
+					// or AsyncWrite
+    UserThreads *userThreads;		// NULL until the first ThreadFork
+    Mapping mapping[MaxMappings];	// files mapped by Mmap
 
     void InitRegisters();		// Initialize user-level CPU registers,
 					// before jumping to user code
 
+    TranslationEntry *MapPage(unsigned int vpn, int frame, bool readOnly);
+    TranslationEntry *FindPage(unsigned int vpn);
+					// Add or look up a translation, in
+					// whichever kind of table we use
+
+    bool MapImage(unsigned int stackPages);
+					// Allocate and map every page
+    void LoadSegment(OpenFile *executable, char *image, int virtualAddr,
+			int size, int inFileAddr);
+					// Copy a segment of the executable
+					// into memory, page by page
+
+    int SwapSlot(unsigned int vpn);	// Swap slot backing "vpn"
+    bool PageInFault(unsigned int vpn);	// Bring in "vpn" for PageFault,
+					// unless it already is
+    bool PageIn(unsigned int vpn);	// Read in "vpn" and maybe more
+    bool CleanRun(unsigned int vpn);	// Write back a run of dirty pages
+    void SyncTlb(unsigned int vpn, bool invalidate);
+					// Copy back TLB use/dirty bits
+    void UnmapPage(unsigned int vpn, int frame);
+					// Remove the translation of "vpn"
+
+    bool HeapPageIn(unsigned int vpn);	// Give a heap page a zeroed frame
+    void FreePages(unsigned int first, unsigned int last);
+					// Unmap and free pages with no
+					// backing store
+    unsigned int ThreadStacksBase() {	// First page of thread stacks,
+					// the last is the user stack's guard
+	return stackBase - 1 - (MaxUserThreads - 1) * (ThreadStackPages + 1); }
+    Mapping *NewMapping(int count);	// Unused mapping, with room for
+					// "count" pages
+    Mapping *FindMapping(unsigned int vpn);
+					// Mapped file containing "vpn"
+    bool FilePageIn(Mapping *m, unsigned int vpn);
+    void FilePageOut(Mapping *m, unsigned int vpn, int frame, bool dirty);
+					// Read or write back a page of a
+					// mapped file
+
 };
 
 #endif // ADDRSPACE_H
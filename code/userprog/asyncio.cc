@@ -0,0 +1,205 @@
+// asyncio.cc
+//	Routines to queue, do and collect asynchronous I/O requests.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "asyncio.h"
+#include "addrspace.h"
+
+//----------------------------------------------------------------------
+// AsyncIOWorker
+// 	Body of the worker thread of "io".
+//----------------------------------------------------------------------
+
+static void
+AsyncIOWorker(AsyncIO *io)
+{
+    io->Serve();
+}
+
+//----------------------------------------------------------------------
+// AsyncIO::AsyncIO
+// 	Initialize an empty set of requests, and fork the kernel thread
+//	that will do them.  The worker runs at "priority", the priority
+//	of the program it works for.
+//----------------------------------------------------------------------
+
+AsyncIO::AsyncIO(int priority)
+{
+    Thread *worker;
+
+    for (int i = 0; i < MaxAsyncIO; i++) {
+	request[i].state = IOFree;
+	request[i].buffer = NULL;
+    }
+    queue = new SynchList<IORequest *>;
+    lock = new Lock("async io");
+    completed = new Condition("async io completed");
+    stopped = new Semaphore("async io stopped", 0);
+
+    worker = new Thread("async io", kernel->NewThreadID(), priority);
+    worker->Fork((VoidFunctionPtr) AsyncIOWorker, (void *) this);
+}
+
+//----------------------------------------------------------------------
+// AsyncIO::~AsyncIO
+// 	Let the worker finish the requests already queued (a write must
+//	not be lost just because the program exited without waiting for
+//	it), then stop it, and de-allocate everything.
+//----------------------------------------------------------------------
+
+AsyncIO::~AsyncIO()
+{
+    queue->Append(NULL);
+    stopped->P();
+
+    for (int i = 0; i < MaxAsyncIO; i++) {
+	delete [] request[i].buffer;
+    }
+    delete queue;
+    delete lock;
+    delete completed;
+    delete stopped;
+}
+
+//----------------------------------------------------------------------
+// AsyncIO::Start
+// 	Queue a read or write of "size" bytes of the user buffer at
+//	"vaddr", on open file "fileId".  The data of a write is copied
+//	in now, so the program may reuse its buffer at once.
+//
+//	At most MaxAsyncSize bytes are transferred, since they are kept
+//	in the kernel meanwhile; as with Read and Write, the result says
+//	how many were.
+//
+//	Returns the id of the request, or -1 if MaxAsyncIO requests are
+//	already outstanding, or the buffer is bad.
+//----------------------------------------------------------------------
+
+int
+AsyncIO::Start(bool writing, int vaddr, int size, int fileId)
+{
+    IORequest *r;
+    int id;
+
+    for (id = 0; id < MaxAsyncIO && request[id].state != IOFree; id++)
+	;
+    if (id == MaxAsyncIO || size < 0) {
+	return -1;
+    }
+    size = min(size, MaxAsyncSize);
+    r = &request[id];
+    r->buffer = new char[size];
+    if (writing && kernel->currentThread->space->CopyIn(vaddr, r->buffer,
+							size) != size) {
+	delete [] r->buffer;
+	r->buffer = NULL;
+	return -1;
+    }
+    r->writing = writing;
+    r->vaddr = vaddr;
+    r->size = size;
+    r->fileId = fileId;
+    r->state = IOQueued;
+    DEBUG(dbgSys, "Async " << (writing ? "write" : "read") << " request "
+		<< id << ", " << size << " bytes");
+    queue->Append(r);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// AsyncIO::Poll
+// 	Return 1 if request "id" has completed, 0 if it is still in
+//	progress, or -1 if there is no such request.
+//----------------------------------------------------------------------
+
+int
+AsyncIO::Poll(int id)
+{
+    int done;
+
+    if (id < 0 || id >= MaxAsyncIO) {
+	return -1;
+    }
+    lock->Acquire();
+    switch (request[id].state) {
+      case IOFree:	done = -1; break;
+      case IOQueued:	done = 0; break;
+      case IODone:	done = 1; break;
+    }
+    lock->Release();
+    return done;
+}
+
+//----------------------------------------------------------------------
+// AsyncIO::Wait
+// 	Wait for request "id" to complete, copy the data of a read out
+//	to the program, and free the request.  Must be called by a
+//	thread of the address space that started the request.
+//
+//	Returns the result of the read or write, or -1 if there is no
+//	such request.
+//----------------------------------------------------------------------
+
+int
+AsyncIO::Wait(int id)
+{
+    IORequest *r;
+    int result;
+
+    if (id < 0 || id >= MaxAsyncIO) {
+	return -1;
+    }
+    r = &request[id];
+    lock->Acquire();
+    while (r->state == IOQueued) {
+	completed->Wait(lock);
+    }
+    if (r->state == IOFree) {		// never started, or collected
+	lock->Release();
+	return -1;
+    }
+    result = r->result;
+    if (!r->writing && result > 0) {
+	kernel->currentThread->space->CopyOut(r->vaddr, r->buffer, result);
+    }
+    delete [] r->buffer;
+    r->buffer = NULL;
+    r->state = IOFree;
+    lock->Release();
+    return result;
+}
+
+//----------------------------------------------------------------------
+// AsyncIO::Serve
+// 	Do the queued requests one at a time, in the order they were
+//	started, until a NULL request says to stop.  The worker blocks
+//	in the file system while the program it works for runs on.
+//----------------------------------------------------------------------
+
+void
+AsyncIO::Serve()
+{
+    IORequest *r;
+
+    while ((r = queue->RemoveFront()) != NULL) {
+	int result;
+
+	if (r->writing) {
+	    result = kernel->Write(r->buffer, r->size, r->fileId);
+	} else {
+	    result = kernel->Read(r->buffer, r->size, r->fileId);
+	}
+	lock->Acquire();
+	r->result = result;
+	r->state = IODone;
+	completed->Broadcast(lock);
+	lock->Release();
+    }
+    stopped->V();
+    kernel->currentThread->Finish();
+}
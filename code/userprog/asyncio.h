@@ -0,0 +1,76 @@
+// asyncio.h
+//	Data structures for asynchronous file I/O by user programs.
+//
+//	AsyncRead and AsyncWrite queue a request and return its id at
+//	once; a kernel thread, one per address space, does the requests
+//	in order, blocking on the disk in place of the user program.
+//	WaitIO waits for a request to complete and collects its result;
+//	PollIO just says whether it has.  So a program can compute while
+//	its I/O is in progress.
+//
+//	The worker never touches user memory: the data of a write is
+//	copied into the kernel when it is queued, and the data of a read
+//	is copied out to the program when it is collected.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef ASYNCIO_H
+#define ASYNCIO_H
+
+#include "copyright.h"
+#include "synch.h"
+#include "synchlist.h"
+
+const int MaxAsyncIO = 16;		// requests per address space not
+					// yet collected
+const int MaxAsyncSize = 4096;		// most bytes one request transfers
+
+enum IOState { IOFree, IOQueued, IODone };
+
+// One asynchronous request.
+
+class IORequest {
+  public:
+    IOState state;
+    bool writing;			// AsyncWrite, rather than AsyncRead
+    int vaddr;				// user buffer
+    int size;				// # of bytes
+    int fileId;				// OpenFileId
+    char *buffer;			// kernel copy of the data
+    int result;				// what Read or Write returned
+};
+
+// The following class keeps the asynchronous requests of one address
+// space, and the kernel thread that does them.
+
+class AsyncIO {
+  public:
+    AsyncIO(int priority);		// Start the worker thread, at
+					// "priority"
+    ~AsyncIO();				// Wait for the requests queued,
+					// and stop the worker
+
+    int Start(bool writing, int vaddr, int size, int fileId);
+					// Queue a request, return its id;
+					// -1 if too many are outstanding
+    int Poll(int id);			// 1 if request "id" is done, 0 if
+					// not; -1 if there is no such request
+    int Wait(int id);			// Wait for request "id", collect it
+					// and return its result; -1 if
+					// there is no such request
+
+    void Serve();			// Do requests until told to stop;
+					// run by the worker thread
+
+  private:
+    IORequest request[MaxAsyncIO];
+    SynchList<IORequest *> *queue;	// requests for the worker; NULL
+					// tells it to stop
+    Lock *lock;				// protects the request states
+    Condition *completed;		// signalled when a request is done
+    Semaphore *stopped;			// signalled when the worker exits
+};
+
+#endif // ASYNCIO_H
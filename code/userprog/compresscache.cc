@@ -0,0 +1,237 @@
+// compresscache.cc
+//	Routines to manage the compressed cache of swapped-out pages.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "compresscache.h"
+#include "swap.h"
+
+const int PageWords = SectorSize / sizeof(int);	// words in a page
+const int MaskWords = divRoundUp(PageWords, BitsInWord);
+					// words in the non-zero bitmask
+
+//----------------------------------------------------------------------
+// Compress
+// 	Compress the page at "page" into "out": first a bitmask with one
+//	bit per word of the page, set if the word is non-zero, then the
+//	non-zero words, in order.  Returns the compressed size in bytes.
+//	"out" must have room for MaskWords + PageWords words.
+//----------------------------------------------------------------------
+
+static int
+Compress(char *page, char *out)
+{
+    unsigned int *words = (unsigned int *) page;
+    unsigned int *mask = (unsigned int *) out;
+    unsigned int *next = mask + MaskWords;
+
+    for (int i = 0; i < MaskWords; i++) {
+	mask[i] = 0;
+    }
+    for (int i = 0; i < PageWords; i++) {
+	if (words[i] != 0) {
+	    mask[i / BitsInWord] |= 1u << (i % BitsInWord);
+	    *next++ = words[i];
+	}
+    }
+    return (next - mask) * sizeof(int);
+}
+
+//----------------------------------------------------------------------
+// Decompress
+// 	Undo Compress: rebuild the page from "in" into "page".
+//----------------------------------------------------------------------
+
+static void
+Decompress(char *in, char *page)
+{
+    unsigned int *words = (unsigned int *) page;
+    unsigned int *mask = (unsigned int *) in;
+    unsigned int *next = mask + MaskWords;
+
+    for (int i = 0; i < PageWords; i++) {
+	if (mask[i / BitsInWord] & (1u << (i % BitsInWord))) {
+	    words[i] = *next++;
+	} else {
+	    words[i] = 0;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// Spend
+// 	Let "time" ticks pass, for the CPU time compressing or
+//	decompressing a page takes.  Time advances through the interrupt
+//	code, a SystemTick at a time, so that the interrupts due meanwhile
+//	happen; the running thread may even be preempted.
+//----------------------------------------------------------------------
+
+static void
+Spend(int time)
+{
+    ASSERT(kernel->interrupt->getLevel() == IntOn);
+    for (int t = 0; t < time; t += SystemTick) {
+	kernel->interrupt->OneTick();
+    }
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::CompressedCache
+// 	Initialize an empty cache, with room for "poolSize" bytes of
+//	compressed pages.
+//----------------------------------------------------------------------
+
+CompressedCache::CompressedCache(int poolSize)
+{
+    for (int i = 0; i < NumSectors; i++) {
+	data[i] = NULL;
+	size[i] = 0;
+	dirty[i] = FALSE;
+    }
+    order = new List<int>;
+    poolBytes = poolSize;
+    usedBytes = 0;
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::~CompressedCache
+// 	De-allocate the cache, and everything in it.
+//----------------------------------------------------------------------
+
+CompressedCache::~CompressedCache()
+{
+    while (!order->IsEmpty()) {
+	Remove(order->Front());
+    }
+    delete order;
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::Store
+// 	Called when the page in swap slot "slot" is evicted from memory.
+//	If it compresses to at most MaxCompressedSize bytes, keep the
+//	compressed copy, and make room for it by writing back the oldest
+//	pages if the pool is now over its bound.  "dirty" says whether
+//	the copy on disk is out of date.
+//
+//	Returns FALSE if the page was rejected; then it's up to the
+//	caller to write it to disk.
+//----------------------------------------------------------------------
+
+bool
+CompressedCache::Store(int slot, char *page, bool isDirty)
+{
+    char buffer[(MaskWords + PageWords) * sizeof(int)];
+    int n = Compress(page, buffer);
+
+    ASSERT(data[slot] == NULL);
+    if (n > MaxCompressedSize) {
+	DEBUG(dbgAddr, "Compressed swap: slot " << slot << " rejected, " << n << " bytes");
+	kernel->stats->numZswapRejects++;
+	Spend(CompressTime);
+	return FALSE;
+    }
+
+    // the new entry goes in before any write back, since that waits
+    // for the disk, and somebody could fault on this page meanwhile
+    data[slot] = new char[n];
+    bcopy(buffer, data[slot], n);
+    size[slot] = n;
+    dirty[slot] = isDirty;
+    order->Append(slot);
+    usedBytes += n;
+    kernel->stats->numZswapStores++;
+    kernel->stats->numZswapBytesIn += PageSize;
+    kernel->stats->numZswapBytesOut += n;
+    DEBUG(dbgAddr, "Compressed swap: slot " << slot << " stored in " << n << " bytes");
+    Spend(CompressTime);
+
+    while (usedBytes > poolBytes) {
+	WriteBackOldest();
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::Load
+// 	Called on a page fault.  If swap slot "slot" is in the cache,
+//	decompress it into "page", and drop it from the cache: it is
+//	now in memory.  "*dirty" is set if the disk copy is out of
+//	date, in which case the page must be treated as modified.
+//
+//	Returns FALSE if the slot isn't cached.
+//----------------------------------------------------------------------
+
+bool
+CompressedCache::Load(int slot, char *page, bool *isDirty)
+{
+    if (data[slot] == NULL) {
+	return FALSE;
+    }
+    Decompress(data[slot], page);
+    kernel->stats->numZswapHits++;
+    *isDirty = dirty[slot];
+    Remove(slot);
+    DEBUG(dbgAddr, "Compressed swap: slot " << slot << " loaded");
+    Spend(DecompressTime);		// after the cache is up to date
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::Invalidate
+// 	Forget any cached copies of slots [first, first+count), when
+//	the address space they belonged to goes away.
+//----------------------------------------------------------------------
+
+void
+CompressedCache::Invalidate(int first, int count)
+{
+    for (int slot = first; slot < first + count; slot++) {
+	if (data[slot] != NULL) {
+	    Remove(slot);
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::Remove
+// 	Drop the entry for "slot" from the cache.
+//----------------------------------------------------------------------
+
+void
+CompressedCache::Remove(int slot)
+{
+    order->Remove(slot);
+    usedBytes -= size[slot];
+    delete [] data[slot];
+    data[slot] = NULL;
+    size[slot] = 0;
+    dirty[slot] = FALSE;
+}
+
+//----------------------------------------------------------------------
+// CompressedCache::WriteBackOldest
+// 	Make room in the pool by evicting its oldest page.  If the copy
+//	on disk is out of date, the page is decompressed and written to
+//	its swap slot; otherwise it is simply dropped.
+//----------------------------------------------------------------------
+
+void
+CompressedCache::WriteBackOldest()
+{
+    int slot = order->Front();
+    bool wasDirty = dirty[slot];
+    char page[SectorSize];
+
+    Decompress(data[slot], page);
+    Remove(slot);			// before waiting for the disk
+    if (wasDirty) {
+	DEBUG(dbgAddr, "Compressed swap: slot " << slot << " written back");
+	kernel->swapSpace->WritePages(slot, 1, page);
+	kernel->stats->numZswapWritebacks++;
+    }
+}
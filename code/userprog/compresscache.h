@@ -0,0 +1,69 @@
+// compresscache.h
+//	Data structures for a compressed cache of swapped-out pages.
+//
+//	Before a page evicted from memory goes to swap on disk, it is
+//	compressed and kept in a bounded pool of kernel memory instead.
+//	A later fault on the page is then served by decompressing it,
+//	which takes a few ticks, rather than by a disk request, which
+//	takes thousands.  When the pool is full, the oldest pages are
+//	written back to their swap slots (or just dropped, if the disk
+//	copy is still current).
+//
+//	Pages are compressed a word at a time: a bitmask says which
+//	words are non-zero, and only those are stored.  This is cheap,
+//	and works very well on the zero-filled arrays and half-used
+//	stacks that make up much of a typical address space.  Pages that
+//	don't shrink to MaxCompressedSize bytes are not worth keeping,
+//	and go straight to disk.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef COMPRESSCACHE_H
+#define COMPRESSCACHE_H
+
+#include "copyright.h"
+#include "list.h"
+#include "disk.h"
+
+const int MaxCompressedSize = (3 * SectorSize) / 4;
+					// reject pages bigger than this
+
+// The following class defines the compressed cache.  Pages are named
+// by their swap slot (see swap.h).
+
+class CompressedCache {
+  public:
+    CompressedCache(int poolBytes);	// Initialize an empty cache, that
+					// holds up to "poolBytes" of
+					// compressed data
+    ~CompressedCache();			// De-allocate the cache
+
+    bool Store(int slot, char *page, bool dirty);
+					// Compress and keep "page", the
+					// contents of "slot"; FALSE if it
+					// doesn't compress well enough
+    bool Load(int slot, char *page, bool *dirty);
+					// If "slot" is cached, decompress it
+					// into "page", remove it from the
+					// cache and return TRUE
+    bool Contains(int slot) { return data[slot] != NULL; }
+    void Invalidate(int first, int count);
+					// Forget slots [first, first+count),
+					// which are no longer in use
+
+  private:
+    void Remove(int slot);		// Drop the entry for "slot"
+    void WriteBackOldest();		// Make room in the pool
+
+    char *data[NumSectors];		// compressed page of each slot,
+					// NULL if not cached
+    int size[NumSectors];		// # of bytes in "data"
+    bool dirty[NumSectors];		// is the disk copy out of date?
+    List<int> *order;			// cached slots, oldest first
+    int poolBytes;			// bound on the pool size
+    int usedBytes;			// compressed bytes in the pool
+};
+
+#endif // COMPRESSCACHE_H
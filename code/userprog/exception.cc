@@ -25,6 +25,631 @@
 #include "main.h"
 #include "syscall.h"
 #include "ksyscall.h"
+#include "syscalltable.h"
+#include "asyncio.h"
+#include "sharedmem.h"
+#include "pipe.h"
+#include "process.h"
+#include "uthread.h"
+
+//----------------------------------------------------------------------
+// WriteFromUser, ReadToUser
+// 	Write "size" bytes of the user buffer at "vaddr" to open file
+//	"id", or read them from it into the buffer.  User virtual pages
+//	need not be contiguous in physical memory, so the buffer is
+//	passed to the file one contiguous run at a time, with no copy;
+//	a buffer in contiguous frames is passed in one call.
+//
+//	A pipe may block, and the pages of the buffer could be paged out
+//	meanwhile; so for a pipe, the data is copied through a kernel
+//	buffer instead.
+//
+//	Returns the number of bytes transferred, or -1 if the file isn't
+//	open or the buffer starts at a bad address.  Stops early at a bad
+//	address, end of file, or a short transfer.
+//----------------------------------------------------------------------
+
+static int
+PipeFromUser(int vaddr, int size, int id)
+{
+    char buffer[PipeSize];
+    int done = 0, length, n;
+
+    while (done < size) {
+	length = kernel->currentThread->space->CopyIn(vaddr + done, buffer,
+					min(size - done, PipeSize));
+	if (length <= 0)
+	    return (done == 0) ? -1 : done;
+	n = SysWrite(buffer, length, id);
+	if (n < 0)
+	    return (done == 0) ? -1 : done;
+	done += n;
+	if (n < length)
+	    break;
+    }
+    return done;
+}
+
+static int
+PipeToUser(int vaddr, int size, int id)
+{
+    char buffer[PipeSize];
+    int n;
+
+    n = SysRead(buffer, min(size, PipeSize), id);
+    if (n <= 0)
+	return n;
+    return kernel->currentThread->space->CopyOut(vaddr, buffer, n);
+}
+
+static int
+WriteFromUser(int vaddr, int size, int id)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    int done = 0, length, n;
+    bool writeEnd;
+
+    if (kernel->FindPipe(id, &writeEnd) != NULL)
+	return PipeFromUser(vaddr, size, id);
+    while (done < size) {
+	char *buffer = space->UserRun(vaddr + done, size - done, FALSE, &length);
+
+	if (buffer == NULL)
+	    return (done == 0) ? -1 : done;
+	n = SysWrite(buffer, length, id);
+	if (n < 0)
+	    return (done == 0) ? -1 : done;
+	done += n;
+	if (n < length)
+	    break;
+    }
+    return done;
+}
+
+static int
+ReadToUser(int vaddr, int size, int id)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    int done = 0, length, n;
+    bool writeEnd;
+
+    if (kernel->FindPipe(id, &writeEnd) != NULL)
+	return PipeToUser(vaddr, size, id);
+    while (done < size) {
+	char *buffer = space->UserRun(vaddr + done, size - done, TRUE, &length);
+
+	if (buffer == NULL)
+	    return (done == 0) ? -1 : done;
+	n = SysRead(buffer, length, id);
+	if (n < 0)
+	    return (done == 0) ? -1 : done;
+	done += n;
+	if (n < length)
+	    break;
+    }
+    return done;
+}
+
+//----------------------------------------------------------------------
+// System call routines, called by SyscallTable::Dispatch with the
+//	arguments already read and checked.  The result goes into r2
+//	if the descriptor says so.
+//----------------------------------------------------------------------
+
+static int
+DoHalt(SyscallArgs *args)
+{
+    DEBUG(dbgSys, "Shutdown, initiated by user program.\n");
+    SysHalt();
+    ASSERTNOTREACHED();
+    return 0;
+}
+
+static int
+DoExit(SyscallArgs *args)
+{
+    DEBUG(dbgAddr, "Program exit\n");
+    AddrSpace *space = kernel->currentThread->space;
+
+    cout << "return value:" << args->value[0] << endl;
+    if (space->MultiThreaded())		// stop the other threads too
+	space->Threads()->ExitProcess(args->value[0]);
+    kernel->processTable->Exit(args->value[0]);
+    ASSERTNOTREACHED();
+    return 0;
+}
+
+static int
+DoExec(SyscallArgs *args)
+{
+    Thread *t = kernel->currentThread;
+
+    return kernel->processTable->Exec(args->string[0], t->getPriority(),
+				t->space->Pid());
+}
+
+static int
+DoJoin(SyscallArgs *args)
+{
+    return kernel->processTable->Join(args->value[0]);
+}
+
+static int
+DoCreate(SyscallArgs *args)
+{
+    return SysCreate(args->string[0]);
+}
+
+static int
+DoAdd(SyscallArgs *args)
+{
+    int result;
+
+    DEBUG(dbgSys, "Add " << args->value[0] << " + " << args->value[1] << "\n");
+    result = SysAdd(args->value[0], args->value[1]);
+    DEBUG(dbgSys, "Add returning with " << result << "\n");
+    cout << "result is " << result << "\n";
+    return result;
+}
+
+static int
+DoMSG(SyscallArgs *args)
+{
+    DEBUG(dbgSys, "Message received.\n");
+    cout << args->string[0] << endl;
+    SysHalt();
+    ASSERTNOTREACHED();
+    return 0;
+}
+
+/* MP1 */
+static int
+DoPrintInt(SyscallArgs *args)
+{
+    SysPrintInt(args->value[0]);
+    return 0;
+}
+
+static int
+DoOpen(SyscallArgs *args)
+{
+    return SysOpen(args->string[0]);
+}
+
+static int
+DoWrite(SyscallArgs *args)
+{
+    return WriteFromUser(args->value[0], args->value[1], args->value[2]);
+}
+
+static int
+DoRead(SyscallArgs *args)
+{
+    return ReadToUser(args->value[0], args->value[1], args->value[2]);
+}
+
+static int
+DoClose(SyscallArgs *args)
+{
+    return SysClose(args->value[0]);
+}
+
+static int
+DoSeek(SyscallArgs *args)
+{
+    return SysSeek(args->value[0], args->value[1]);
+}
+
+//----------------------------------------------------------------------
+// DoRegisterRing
+// 	Remember where this program's IoRing is (see syscall.h), after
+//	checking that it lies inside the address space.
+//----------------------------------------------------------------------
+
+static int
+DoRegisterRing(SyscallArgs *args)
+{
+    unsigned int ring = args->value[0];
+
+    if (ring % sizeof(int) != 0 || ring > UserStackTop - sizeof(IoRing))
+	return -1;
+    kernel->currentThread->space->SetRing(ring);
+    return 1;
+}
+
+//----------------------------------------------------------------------
+// CopyRing
+// 	Copy "count" entries of "entrySize" bytes, starting with entry
+//	"first" (modulo RingSize), between the ring at user address
+//	"vaddr" and "buffer".  The entries wrap around the end of the
+//	ring, so this takes at most two copies.  The words are converted
+//	between the byte order of the host and of the simulated machine.
+//
+//	Returns FALSE if part of the ring is not a valid address.
+//----------------------------------------------------------------------
+
+static bool
+CopyRing(int vaddr, int first, int count, int entrySize, int *buffer,
+	bool out)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    int words = count * entrySize / sizeof(int);
+    int start = (first & (RingSize - 1)) * entrySize;
+    int part = min(count, RingSize - (first & (RingSize - 1))) * entrySize;
+    int rest = count * entrySize - part;
+
+    if (out) {
+	for (int i = 0; i < words; i++)
+	    buffer[i] = WordToMachine(buffer[i]);
+	return space->CopyOut(vaddr + start, (char *) buffer, part) == part
+	    && space->CopyOut(vaddr, (char *) buffer + part, rest) == rest;
+    }
+    if (space->CopyIn(vaddr + start, (char *) buffer, part) != part
+	    || space->CopyIn(vaddr, (char *) buffer + part, rest) != rest)
+	return FALSE;
+    for (int i = 0; i < words; i++)
+	buffer[i] = WordToHost(buffer[i]);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// RunRingRequest
+// 	Do one request from the ring, just as the system call it stands
+//	for would, and return the result.
+//----------------------------------------------------------------------
+
+static int
+RunRingRequest(RingRequest *request)
+{
+    char name[MaxStringArg];
+
+    switch (request->op) {
+      case RingRead:
+	return ReadToUser(request->addr, request->size, request->id);
+      case RingWrite:
+	return WriteFromUser(request->addr, request->size, request->id);
+      case RingOpen:
+	if (kernel->currentThread->space->CopyInString(request->addr, name,
+			MaxStringArg) < 0)
+	    return -1;
+	return SysOpen(name);
+      case RingClose:
+	return SysClose(request->id);
+      case RingSeek:
+	return SysSeek(request->size, request->id);
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// DoSubmitAndWait
+// 	Run the requests queued in this program's ring, in order, and
+//	post their completions.  The whole batch costs one trap: the
+//	indices are read once, the requests are copied in with at most
+//	two copies, and the completions and indices are copied out the
+//	same way.  Stops early if the completion ring fills up.
+//----------------------------------------------------------------------
+
+static int
+DoSubmitAndWait(SyscallArgs *args)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    int ring = space->Ring();
+    const int sqOffset = 4 * sizeof(int);	// offsets in IoRing
+    const int cqOffset = sqOffset + RingSize * sizeof(RingRequest);
+    int index[4];			// sqHead, sqTail, cqHead, cqTail
+    RingRequest request[RingSize];
+    RingCompletion done[RingSize];
+    int queued, room, n;
+
+    if (ring == -1 || !CopyRing(ring, 0, 1, sizeof(index), index, FALSE))
+	return -1;
+    queued = index[1] - index[0];
+    room = RingSize - (index[3] - index[2]);
+    if (queued < 0 || queued > RingSize || room < 0 || room > RingSize)
+	return -1;
+    n = min(queued, room);
+    if (!CopyRing(ring + sqOffset, index[0], n, sizeof(RingRequest),
+			(int *) request, FALSE))
+	return -1;
+
+    DEBUG(dbgSys, "Ring: running " << n << " of " << queued << " requests");
+    for (int i = 0; i < n; i++) {
+	done[i].userData = request[i].userData;
+	done[i].result = RunRingRequest(&request[i]);
+    }
+
+    // completions first, so the program never sees an index ahead
+    // of the entries it covers
+    index[0] += n;
+    index[3] += n;
+    if (!CopyRing(ring + cqOffset, index[3] - n, n, sizeof(RingCompletion),
+			(int *) done, TRUE)
+	    || !CopyRing(ring, 0, 1, sizeof(index), index, TRUE))
+	return -1;
+    return n;
+}
+
+static int
+DoAsyncRead(SyscallArgs *args)
+{
+    return kernel->currentThread->space->AsyncRequests()->Start(FALSE,
+			args->value[0], args->value[1], args->value[2]);
+}
+
+static int
+DoAsyncWrite(SyscallArgs *args)
+{
+    return kernel->currentThread->space->AsyncRequests()->Start(TRUE,
+			args->value[0], args->value[1], args->value[2]);
+}
+
+// WaitIO and PollIO don't start the worker thread: with no request
+// made yet, there is no such request.
+
+static int
+DoWaitIO(SyscallArgs *args)
+{
+    AddrSpace *space = kernel->currentThread->space;
+
+    if (!space->HasAsyncRequests())
+	return -1;
+    return space->AsyncRequests()->Wait(args->value[0]);
+}
+
+static int
+DoPollIO(SyscallArgs *args)
+{
+    AddrSpace *space = kernel->currentThread->space;
+
+    if (!space->HasAsyncRequests())
+	return -1;
+    return space->AsyncRequests()->Poll(args->value[0]);
+}
+
+static int
+DoMmap(SyscallArgs *args)
+{
+    return kernel->currentThread->space->Mmap(args->value[0], args->value[1],
+			args->value[2]);
+}
+
+static int
+DoMunmap(SyscallArgs *args)
+{
+    return kernel->currentThread->space->Munmap(args->value[0]) ? 1 : -1;
+}
+
+//----------------------------------------------------------------------
+// CopyInVector
+// 	Copy in the "count" IoVec's at user address "vaddr", checking
+//	that each buffer lies inside the address space.  Returns the
+//	total size of the buffers, or -1 if something is bad.
+//----------------------------------------------------------------------
+
+static int
+CopyInVector(int vaddr, int count, IoVec *vec)
+{
+    int total = 0;
+
+    if (count < 0 || count > MaxIoVec)
+	return -1;
+    if (kernel->currentThread->space->CopyIn(vaddr, (char *) vec,
+		count * sizeof(IoVec)) != (int) (count * sizeof(IoVec)))
+	return -1;
+    for (int i = 0; i < count; i++) {
+	unsigned int addr = vec[i].addr = WordToHost(vec[i].addr);
+	int size = vec[i].size = WordToHost(vec[i].size);
+
+	if (size < 0 || addr >= UserStackTop
+		|| (unsigned int) size > UserStackTop - addr
+		|| size > (int) UserStackTop - total)
+	    return -1;
+	total += size;
+    }
+    return total;
+}
+
+//----------------------------------------------------------------------
+// DoReadV, DoWriteV
+// 	Vectored I/O.  Each buffer is read or written in turn, straight
+//	from the program's memory as Read and Write do, so the kernel
+//	never holds a copy of them all.  It stops at the first buffer
+//	not read or written in full: the end of the file, or a pipe
+//	with no more data for now.
+//----------------------------------------------------------------------
+
+static int
+DoReadV(SyscallArgs *args)
+{
+    IoVec vec[MaxIoVec];
+    int count = args->value[1];
+    int n, done = 0;
+
+    if (CopyInVector(args->value[0], count, vec) < 0)
+	return -1;
+    for (int i = 0; i < count; i++) {
+	n = ReadToUser(vec[i].addr, vec[i].size, args->value[2]);
+	if (n < 0)
+	    return (done == 0) ? -1 : done;
+	done += n;
+	if (n < vec[i].size)
+	    break;
+    }
+    return done;
+}
+
+static int
+DoWriteV(SyscallArgs *args)
+{
+    IoVec vec[MaxIoVec];
+    int count = args->value[1];
+    int n, done = 0;
+
+    if (CopyInVector(args->value[0], count, vec) < 0)
+	return -1;
+    for (int i = 0; i < count; i++) {
+	n = WriteFromUser(vec[i].addr, vec[i].size, args->value[2]);
+	if (n < 0)
+	    return (done == 0) ? -1 : done;
+	done += n;
+	if (n < vec[i].size)
+	    break;
+    }
+    return done;
+}
+
+static int
+DoSbrk(SyscallArgs *args)
+{
+    return kernel->currentThread->space->Sbrk(args->value[0]);
+}
+
+static int
+DoShmCreate(SyscallArgs *args)
+{
+    return kernel->sharedMemory->Create(args->value[0], args->value[1]);
+}
+
+static int
+DoShmAttach(SyscallArgs *args)
+{
+    return kernel->currentThread->space->ShmAttach(args->value[0]);
+}
+
+static int
+DoShmDetach(SyscallArgs *args)
+{
+    return kernel->currentThread->space->ShmDetach(args->value[0]) ? 1 : -1;
+}
+
+//----------------------------------------------------------------------
+// DoPipe
+// 	Create a pipe, and store the ids of its read and write ends in
+//	the two words at "ends".
+//----------------------------------------------------------------------
+
+static int
+DoPipe(SyscallArgs *args)
+{
+    int ends[2];
+
+    kernel->NewPipe(&ends[0], &ends[1]);
+    ends[0] = WordToMachine(ends[0]);
+    ends[1] = WordToMachine(ends[1]);
+    if (kernel->currentThread->space->CopyOut(args->value[0], (char *) ends,
+			sizeof(ends)) != sizeof(ends)) {
+	SysClose(WordToHost(ends[0]));
+	SysClose(WordToHost(ends[1]));
+	return -1;
+    }
+    return 0;
+}
+
+static int
+DoThreadFork(SyscallArgs *args)
+{
+    return kernel->currentThread->space->Threads()->Fork(args->value[0],
+							args->value[1]);
+}
+
+static int
+DoThreadYield(SyscallArgs *args)
+{
+    kernel->scheduler->RealTime()->Throttle(kernel->currentThread);
+    return 0;
+}
+
+static int
+DoSetDeadline(SyscallArgs *args)
+{
+    return kernel->scheduler->RealTime()->SetDeadline(kernel->currentThread,
+						args->value[0], args->value[1]);
+}
+
+static int
+DoThreadJoin(SyscallArgs *args)
+{
+    return kernel->currentThread->space->Threads()->Join(args->value[0]);
+}
+
+static int
+DoThreadExit(SyscallArgs *args)
+{
+    kernel->currentThread->space->Threads()->Exit(args->value[0]);
+    ASSERTNOTREACHED();
+    return 0;
+}
+
+// The system calls supported by the kernel.  A system call with a bad
+// string or buffer argument isn't called; it returns the last field.
+
+SyscallDesc syscallDesc[] = {
+//    code         name        routine     args, kinds                          r2?    error
+    { SC_Halt,     "Halt",     DoHalt,     0, { IntArg },                       FALSE, 0 },
+    { SC_Exit,     "Exit",     DoExit,     1, { IntArg },                       FALSE, 0 },
+    { SC_Exec,     "Exec",     DoExec,     1, { StringArg },                    TRUE,  -1 },
+    { SC_Join,     "Join",     DoJoin,     1, { IntArg },                       TRUE,  -1 },
+    { SC_Create,   "Create",   DoCreate,   1, { StringArg },                    TRUE,  0 },
+    { SC_Add,      "Add",      DoAdd,      2, { IntArg, IntArg },               TRUE,  0 },
+    { SC_MSG,      "MSG",      DoMSG,      1, { StringArg },                    FALSE, 0 },
+    { SC_PrintInt, "PrintInt", DoPrintInt, 1, { IntArg },                       FALSE, 0 },
+    { SC_Open,     "Open",     DoOpen,     1, { StringArg },                    TRUE,  -1 },
+    { SC_Write,    "Write",    DoWrite,    3, { BufferArg, IntArg, IntArg },    TRUE,  -1 },
+    { SC_Read,     "Read",     DoRead,     3, { BufferArg, IntArg, IntArg },    TRUE,  -1 },
+    { SC_Close,    "Close",    DoClose,    1, { IntArg },                       TRUE,  -1 },
+    { SC_Seek,     "Seek",     DoSeek,     2, { IntArg, IntArg },               TRUE,  -1 },
+    { SC_RegisterRing, "RegisterRing", DoRegisterRing,
+                               1, { IntArg },                       TRUE,  -1 },
+    { SC_SubmitAndWait, "SubmitAndWait", DoSubmitAndWait,
+                               0, { IntArg },                       TRUE,  -1 },
+    { SC_AsyncRead,  "AsyncRead",  DoAsyncRead,
+                               3, { BufferArg, IntArg, IntArg },    TRUE,  -1 },
+    { SC_AsyncWrite, "AsyncWrite", DoAsyncWrite,
+                               3, { BufferArg, IntArg, IntArg },    TRUE,  -1 },
+    { SC_WaitIO,   "WaitIO",   DoWaitIO,   1, { IntArg },                       TRUE,  -1 },
+    { SC_PollIO,   "PollIO",   DoPollIO,   1, { IntArg },                       TRUE,  -1 },
+    { SC_Mmap,     "Mmap",     DoMmap,     3, { IntArg, IntArg, IntArg },       TRUE,  0 },
+    { SC_Munmap,   "Munmap",   DoMunmap,   1, { IntArg },                       TRUE,  -1 },
+    { SC_ReadV,    "ReadV",    DoReadV,    3, { IntArg, IntArg, IntArg },       TRUE,  -1 },
+    { SC_WriteV,   "WriteV",   DoWriteV,   3, { IntArg, IntArg, IntArg },       TRUE,  -1 },
+    { SC_Sbrk,     "Sbrk",     DoSbrk,     1, { IntArg },                       TRUE,  -1 },
+    { SC_ShmCreate, "ShmCreate", DoShmCreate,
+                               2, { IntArg, IntArg },               TRUE,  -1 },
+    { SC_ShmAttach, "ShmAttach", DoShmAttach,
+                               1, { IntArg },                       TRUE,  0 },
+    { SC_ShmDetach, "ShmDetach", DoShmDetach,
+                               1, { IntArg },                       TRUE,  -1 },
+    { SC_Pipe,     "Pipe",     DoPipe,     1, { IntArg },                       TRUE,  -1 },
+    { SC_ThreadFork, "ThreadFork", DoThreadFork,
+                               2, { IntArg, IntArg },               TRUE,  -1 },
+    { SC_ThreadYield, "ThreadYield", DoThreadYield,
+                               0, { IntArg },                       FALSE, 0 },
+    { SC_ThreadJoin, "ThreadJoin", DoThreadJoin,
+                               1, { IntArg },                       TRUE,  -1 },
+    { SC_ThreadExit, "ThreadExit", DoThreadExit,
+                               1, { IntArg },                       FALSE, 0 },
+    { SC_SetDeadline, "SetDeadline", DoSetDeadline,
+                               2, { IntArg, IntArg },               TRUE,  -1 },
+};
+
+int numSyscallDesc = sizeof(syscallDesc) / sizeof(SyscallDesc);
+
+//----------------------------------------------------------------------
+// ReturnToUser
+// 	Called before a thread goes back to user mode.  A thread of a
+//	program that is exiting is finished instead.
+//----------------------------------------------------------------------
+
+static void
+ReturnToUser()
+{
+    AddrSpace *space = kernel->currentThread->space;
+
+    if (space != NULL && space->MultiThreaded())
+	space->Threads()->CheckExiting();
+}
+
 //----------------------------------------------------------------------
 // ExceptionHandler
 // 	Entry point into the Nachos kernel.  Called when a user program
@@ -40,9 +665,8 @@
 //		arg4 -- r7
 //
 //	The result of the system call, if any, must be put back into r2.
-//
-// If you are handling a system call, don't forget to increment the pc
-// before returning. (Or else you'll loop making the same system call forever!)
+//	System calls are looked up in syscallDesc, which does that, and
+//	increments the pc, for every system call.
 //
 //	"which" is the kind of exception.  The list of possible exceptions
 //	is in machine.h.
@@ -53,143 +677,26 @@ ExceptionHandler(ExceptionType which)
 {
     int type = kernel->machine->ReadRegister(2);
 	int val;
-    int status, exit, threadID, programID;
 	DEBUG(dbgSys, "Received Exception " << which << " type: " << type << "\n");
     switch (which) {
     case SyscallException:
-      	switch(type) {
-
-        /* MP1 */
-        case SC_PrintInt:
-            SysPrintInt((int)kernel->machine->ReadRegister(4));
-            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-            return;
-			ASSERTNOTREACHED();
-            break;
-
-        case SC_Open:
-            val = kernel->machine->ReadRegister(4);
-            {
-            char *filename = &(kernel->machine->mainMemory[val]);
-            status = (int) SysOpen(filename);
-            kernel->machine->WriteRegister(2, (int) status);
-            }
-            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-            return;
-			ASSERTNOTREACHED();
-            break;
-
-        case SC_Write:
-            {
-            int buffer = kernel->machine->ReadRegister(4);
-            int size = kernel->machine->ReadRegister(5);
-            int id = kernel->machine->ReadRegister(6);
-            char* cbuffer = &(kernel->machine->mainMemory[buffer]);
-            status = (int) SysWrite(cbuffer , size , id);
-            kernel->machine->WriteRegister(2, (int) status);
-            }
-            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-            return;
-            ASSERTNOTREACHED();
-            break;
-
-        case SC_Read:
-            {
-            int buffer = kernel->machine->ReadRegister(4);
-            int size = kernel->machine->ReadRegister(5);
-            int id = kernel->machine->ReadRegister(6);
-            char* cbuffer = &(kernel->machine->mainMemory[buffer]);
-            status = (int) SysRead(cbuffer , size , id);
-            kernel->machine->WriteRegister(2, (int) status);
-            }
-            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-            return;
-            ASSERTNOTREACHED();
-            break;
-
-        case SC_Close:
-            val = kernel->machine->ReadRegister(4);
-            status = SysClose(val);
-            kernel->machine->WriteRegister(2, (int) status);
-            kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-            kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-            kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-            return;
-            ASSERTNOTREACHED();
-            break;
-
-      	case SC_Halt:
-			DEBUG(dbgSys, "Shutdown, initiated by user program.\n");
-			SysHalt();
-                        cout<<"in exception\n";
-			ASSERTNOTREACHED();
-			break;
-		case SC_MSG:
-			DEBUG(dbgSys, "Message received.\n");
-			val = kernel->machine->ReadRegister(4);
-			{
-			char *msg = &(kernel->machine->mainMemory[val]);
-			cout << msg << endl;
-			}
-			SysHalt();
-			ASSERTNOTREACHED();
-			break;
-		case SC_Create:
-			val = kernel->machine->ReadRegister(4);
-			{
-			char *filename = &(kernel->machine->mainMemory[val]);
-			//cout << filename << endl;
-			status = SysCreate(filename);
-			kernel->machine->WriteRegister(2, (int) status);
-			}
-			kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-			kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-			kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-			return;
-			ASSERTNOTREACHED();
-            break;
-      	case SC_Add:
-			DEBUG(dbgSys, "Add " << kernel->machine->ReadRegister(4) << " + " << kernel->machine->ReadRegister(5) << "\n");
-			/* Process SysAdd Systemcall*/
-			int result;
-			result = SysAdd(/* int op1 */(int)kernel->machine->ReadRegister(4),
-			/* int op2 */(int)kernel->machine->ReadRegister(5));
-			DEBUG(dbgSys, "Add returning with " << result << "\n");
-			/* Prepare Result */
-			kernel->machine->WriteRegister(2, (int)result);
-			/* Modify return point */
-			{
-	  		/* set previous programm counter (debugging only)*/
-	  		kernel->machine->WriteRegister(PrevPCReg, kernel->machine->ReadRegister(PCReg));
-
-			/* set programm counter to next instruction (all Instructions are 4 byte wide)*/
-	  		kernel->machine->WriteRegister(PCReg, kernel->machine->ReadRegister(PCReg) + 4);
-
-	 		/* set next programm counter for brach execution */
-	 		kernel->machine->WriteRegister(NextPCReg, kernel->machine->ReadRegister(PCReg)+4);
-			}
-			cout << "result is " << result << "\n";
-			return;
-			ASSERTNOTREACHED();
-            break;
-		case SC_Exit:
-			DEBUG(dbgAddr, "Program exit\n");
-            val=kernel->machine->ReadRegister(4);
-            cout << "return value:" << val << endl;
-			kernel->currentThread->Finish();
-            break;
-      	default:
-			cerr << "Unexpected system call " << type << "\n";
-			break;
+	if (kernel->syscallTable->Dispatch(type)) {
+	    ReturnToUser();
+	    return;
+	}
+	cerr << "Unexpected system call " << type << "\n";
+	break;
+	case PageFaultException:
+		val = kernel->machine->ReadRegister(BadVAddrReg);
+		if (kernel->currentThread->space->PageFault(val)) {
+			ReturnToUser();
+			return;		// retry the faulting instruction
 		}
+		cerr << "Illegal memory access at " << val << "\n";
+		if (kernel->currentThread->space->MultiThreaded())
+			kernel->currentThread->space->Threads()->ExitProcess(-1);
+		kernel->processTable->Exit(-1);	// so its parent can Join it
+		ASSERTNOTREACHED();
 		break;
 	default:
 		cerr << "Unexpected user mode exception " << (int)which << "\n";
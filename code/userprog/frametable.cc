@@ -0,0 +1,501 @@
+// frametable.cc
+//	Routines to allocate and free physical page frames.
+//
+//	The bitmap is always scanned a word at a time: a word equal to
+//	~0 has no free frames and is skipped with a single compare, and
+//	inside a word the first free frame is found with a count of
+//	trailing zeroes.  Bits past the last frame in the final word
+//	are kept set, so a scan never has to check for running off the
+//	end of memory.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "main.h"
+#include "frametable.h"
+
+//----------------------------------------------------------------------
+// FirstClear, RunMask
+//	Bit twiddling helpers.  FirstClear returns the index of the
+//	lowest clear bit of "word", which must not be all ones.
+//	RunMask returns a mask of "count" ones, starting at bit "first".
+//----------------------------------------------------------------------
+
+static inline int
+FirstClear(unsigned int word)
+{
+    return __builtin_ctz(~word);
+}
+
+static inline unsigned int
+RunMask(int first, int count)
+{
+    if (count == BitsInWord) {
+	return ~0u;
+    }
+    return ((1u << count) - 1) << first;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::FrameTable
+// 	Initialize a frame table with "numFrames" frames, all free.
+//----------------------------------------------------------------------
+
+FrameTable::FrameTable(int numFrames) : Bitmap(numFrames)
+{
+    int tail = numBits % BitsInWord;
+
+    if (tail != 0) {		// padding bits are permanently "in use"
+	map[numWords - 1] |= ~RunMask(0, tail);
+    }
+    numFree = numBits;
+    nextWord = 0;
+    zeroed = new unsigned int[numWords];
+    for (int i = 0; i < numWords; i++) {
+	zeroed[i] = 0;			// nothing known yet
+    }
+    owner = new AddrSpace *[numBits];
+    ownerPage = new int[numBits];
+    for (int i = 0; i < numBits; i++) {
+	owner[i] = NULL;
+	ownerPage[i] = -1;
+    }
+
+    numAllocated = numReleased = 0;
+    minFree = numFree;
+    contiguousRequests = contiguousFailures = 0;
+    numZeroedIdle = numZeroHits = numZeroMisses = 0;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::~FrameTable
+// 	De-allocate a frame table.  The bit storage is freed by ~Bitmap.
+//----------------------------------------------------------------------
+
+FrameTable::~FrameTable()
+{
+    delete [] zeroed;
+    delete [] owner;
+    delete [] ownerPage;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Allocate
+// 	Find a free frame, mark it in use and return its number.
+//	Returns -1 if all of physical memory is in use.
+//----------------------------------------------------------------------
+
+int
+FrameTable::Allocate()
+{
+    if (numFree == 0) {
+	return -1;
+    }
+    for (int w = nextWord; w < numWords; w++) {
+	if (map[w] != ~0u) {
+	    int bit = FirstClear(map[w]);
+
+	    map[w] |= 1u << bit;
+	    nextWord = w;
+	    numFree--;
+	    numAllocated++;
+	    minFree = min(minFree, numFree);
+	    return w * BitsInWord + bit;
+	}
+    }
+    ASSERTNOTREACHED();		// numFree said there was a free frame
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Allocate
+// 	Allocate "count" frames at once, storing their numbers into
+//	"frames".  Frames are taken a word at a time, so a batch of
+//	N frames costs about N / BitsInWord word reads.
+//
+//	Returns FALSE, without allocating anything, if fewer than
+//	"count" frames are free.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::Allocate(int count, int *frames)
+{
+    int n = 0;
+
+    if (count > numFree) {
+	return FALSE;
+    }
+    for (int w = nextWord; n < count && w < numWords; w++) {
+	unsigned int freeBits = ~map[w];
+
+	while (freeBits != 0 && n < count) {
+	    int bit = __builtin_ctz(freeBits);
+
+	    freeBits &= freeBits - 1;		// drop the lowest free bit
+	    map[w] |= 1u << bit;
+	    frames[n++] = w * BitsInWord + bit;
+	}
+	nextWord = w;
+    }
+    ASSERT(n == count);
+    numFree -= count;
+    numAllocated += count;
+    minFree = min(minFree, numFree);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::AllocateContiguous
+// 	Allocate a run of "count" physically contiguous frames whose
+//	first frame number is a multiple of "align".  Used for large
+//	pages, which need aligned backing memory.
+//
+//	Returns the first frame of the run, or -1 if there is none.
+//----------------------------------------------------------------------
+
+int
+FrameTable::AllocateContiguous(int count, int align)
+{
+    ASSERT(count > 0 && align > 0);
+
+    contiguousRequests++;
+    if (count <= numFree) {
+	for (int first = 0; first + count <= numBits; first += align) {
+	    if (map[first / BitsInWord] == ~0u) {
+		// whole word in use, skip to the next aligned frame
+		// in the following word
+		int next = (first / BitsInWord + 1) * BitsInWord;
+		first = divRoundUp(next, align) * align - align;
+		continue;
+	    }
+	    if (RunIsFree(first, count)) {
+		MarkRun(first, count);
+		numFree -= count;
+		numAllocated += count;
+		minFree = min(minFree, numFree);
+		return first;
+	    }
+	}
+    }
+    contiguousFailures++;
+    DEBUG(dbgAddr, "No run of " << count << " free frames aligned to " << align);
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Free
+// 	Return frame "frame" to the pool of free frames.
+//----------------------------------------------------------------------
+
+void
+FrameTable::Free(int frame)
+{
+    ASSERT(Test(frame));		// must have been allocated
+
+    Clear(frame);
+    zeroed[frame / BitsInWord] &= ~(1u << (frame % BitsInWord));
+    owner[frame] = NULL;
+    if (frame / BitsInWord < nextWord) {
+	nextWord = frame / BitsInWord;	// prefer low frames next time
+    }
+    numFree++;
+    numReleased++;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::Free
+// 	Return a batch of "count" frames, listed in "frames".
+//----------------------------------------------------------------------
+
+void
+FrameTable::Free(int count, int *frames)
+{
+    for (int i = 0; i < count; i++) {
+	Free(frames[i]);
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::FreeContiguous
+// 	Return the run of "count" frames starting at "first", as
+//	handed out by AllocateContiguous.
+//----------------------------------------------------------------------
+
+void
+FrameTable::FreeContiguous(int first, int count)
+{
+    ClearRun(first, count);
+    if (first / BitsInWord < nextWord) {
+	nextWord = first / BitsInWord;
+    }
+    numFree += count;
+    numReleased += count;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::SetOwner
+// 	Record that frame "frame" holds virtual page "vpn" of address
+//	space "space".  Only frames with an owner are considered for
+//	page replacement; a frame that is being filled, or emptied, or
+//	that must stay in memory, has none.
+//----------------------------------------------------------------------
+
+void
+FrameTable::SetOwner(int frame, AddrSpace *space, int vpn)
+{
+    ASSERT(Test(frame));
+    zeroed[frame / BitsInWord] &= ~(1u << (frame % BitsInWord));
+    owner[frame] = space;
+    ownerPage[frame] = vpn;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::ZeroFill
+// 	Called on a newly allocated frame that must start out all
+//	zeroes (so it doesn't show its previous owner's data).  Usually
+//	the idle loop has already cleared it; otherwise do it now.
+//
+//	The frame is about to be written, so it is no longer known to be
+//	zero.  Neither is a frame once it has an owner (see SetOwner):
+//	paging can hand it to another page without freeing it.
+//----------------------------------------------------------------------
+
+void
+FrameTable::ZeroFill(int frame)
+{
+    unsigned int bit = 1u << (frame % BitsInWord);
+
+    ASSERT(Test(frame));
+    if (zeroed[frame / BitsInWord] & bit) {
+	zeroed[frame / BitsInWord] &= ~bit;
+	numZeroHits++;
+	return;
+    }
+    bzero(&(kernel->machine->mainMemory[frame * PageSize]), PageSize);
+    numZeroMisses++;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::ZeroFreeFrames
+// 	Clear every free frame not yet known to be zero.  Called from
+//	Interrupt::Idle, so the work is done while the CPU would
+//	otherwise wait.  Returns the number of frames cleared.
+//----------------------------------------------------------------------
+
+int
+FrameTable::ZeroFreeFrames()
+{
+    int n = 0;
+
+    for (int w = 0; w < numWords; w++) {
+	unsigned int dirty = ~(map[w] | zeroed[w]);	// free, not zero
+
+	while (dirty != 0) {
+	    int frame = w * BitsInWord + __builtin_ctz(dirty);
+
+	    dirty &= dirty - 1;
+	    bzero(&(kernel->machine->mainMemory[frame * PageSize]), PageSize);
+	    n++;
+	}
+	zeroed[w] |= ~map[w];
+    }
+    numZeroedIdle += n;
+    return n;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::RunIsFree, MarkRun, ClearRun
+// 	Test, set or clear the bits for frames [first, first + count),
+//	one word (or partial word at either end) at a time.
+//----------------------------------------------------------------------
+
+bool
+FrameTable::RunIsFree(int first, int count) const
+{
+    int end = first + count;
+
+    ASSERT(first >= 0 && end <= numBits);
+    while (first < end) {
+	int offset = first % BitsInWord;
+	int n = min(BitsInWord - offset, end - first);
+
+	if (map[first / BitsInWord] & RunMask(offset, n)) {
+	    return FALSE;
+	}
+	first += n;
+    }
+    return TRUE;
+}
+
+void
+FrameTable::MarkRun(int first, int count)
+{
+    int end = first + count;
+
+    while (first < end) {
+	int offset = first % BitsInWord;
+	int n = min(BitsInWord - offset, end - first);
+
+	map[first / BitsInWord] |= RunMask(offset, n);
+	first += n;
+    }
+}
+
+void
+FrameTable::ClearRun(int first, int count)
+{
+    int end = first + count;
+
+    ASSERT(first >= 0 && end <= numBits);
+    while (first < end) {
+	int offset = first % BitsInWord;
+	int n = min(BitsInWord - offset, end - first);
+	unsigned int mask = RunMask(offset, n);
+
+	ASSERT((map[first / BitsInWord] & mask) == mask);
+	map[first / BitsInWord] &= ~mask;
+	zeroed[first / BitsInWord] &= ~mask;	// contents are stale
+	first += n;
+    }
+}
+
+//----------------------------------------------------------------------
+// FrameTable::NumFreeRuns
+// 	Return the number of maximal runs of free frames.  A run starts
+//	at every free frame whose predecessor is in use, which can be
+//	computed for a whole word with a shift and a population count.
+//----------------------------------------------------------------------
+
+int
+FrameTable::NumFreeRuns() const
+{
+    int runs = 0;
+    unsigned int carry = 0;		// was the last frame of the
+					// previous word free?
+
+    for (int w = 0; w < numWords; w++) {
+	unsigned int freeBits = ~map[w];
+	unsigned int starts = freeBits & ~((freeBits << 1) | carry);
+
+	runs += __builtin_popcount(starts);
+	carry = freeBits >> (BitsInWord - 1);
+    }
+    return runs;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::LargestFreeRun
+// 	Return the length of the longest run of free frames -- the
+//	largest contiguous allocation that could currently succeed.
+//----------------------------------------------------------------------
+
+int
+FrameTable::LargestFreeRun() const
+{
+    int largest = 0, current = 0;
+
+    for (int w = 0; w < numWords; w++) {
+	if (map[w] == 0) {		// whole word free
+	    current += BitsInWord;
+	    largest = max(largest, current);
+	    continue;
+	}
+	for (int bit = 0; bit < BitsInWord; bit++) {
+	    if (map[w] & (1u << bit)) {
+		current = 0;
+	    } else {
+		current++;
+		largest = max(largest, current);
+	    }
+	}
+    }
+    return largest;
+}
+
+//----------------------------------------------------------------------
+// FrameTable::PrintStats
+// 	Print occupancy and fragmentation counters, for debugging and
+//	at system shutdown.
+//
+//	Fragmentation is the fraction of free memory that lies outside
+//	the largest free run: 0% means all free frames are contiguous.
+//----------------------------------------------------------------------
+
+void
+FrameTable::PrintStats() const
+{
+    int largest = LargestFreeRun();
+
+    cout << "Frames: total " << numBits << ", in use " << NumUsed();
+    cout << ", free " << numFree << ", min free " << minFree << "\n";
+    cout << "Frames: allocated " << numAllocated;
+    cout << ", released " << numReleased << "\n";
+    cout << "Frames: free runs " << NumFreeRuns();
+    cout << ", largest run " << largest << ", fragmentation ";
+    cout << (numFree == 0 ? 0 : 100 * (numFree - largest) / numFree) << "%\n";
+    cout << "Frames: contiguous requests " << contiguousRequests;
+    cout << ", failed " << contiguousFailures << "\n";
+    cout << "Frames: zeroed when idle " << numZeroedIdle;
+    cout << ", allocated pre-zeroed " << numZeroHits;
+    cout << ", zeroed on allocation " << numZeroMisses << "\n";
+}
+
+//----------------------------------------------------------------------
+// FrameTable::SelfTest
+// 	Test whether this module is working.  Must be run on a frame
+//	table with nothing allocated and at least 80 frames, before any
+//	program is loaded: it writes to physical memory.
+//----------------------------------------------------------------------
+
+void
+FrameTable::SelfTest()
+{
+    int frames[40];
+    int first;
+    char *memory;
+
+    ASSERT(numBits >= 80);
+    ASSERT(NumFree() == numBits && NumFreeRuns() == 1);
+
+    ASSERT(Allocate() == 0);
+    ASSERT(Allocate(40, frames));		// frames 1 .. 40
+    ASSERT(frames[0] == 1 && frames[39] == 40);
+    ASSERT(NumUsed() == 41);
+
+    first = AllocateContiguous(16, 16);		// skips 0, 16 and 32
+    ASSERT(first == 48);
+    ASSERT(NumFreeRuns() == 2 && NumUsed() == 57);
+
+    Free(40, frames);
+    Free(0);
+    ASSERT(NumFreeRuns() == 2 && LargestFreeRun() == numBits - 64);
+    FreeContiguous(first, 16);
+    ASSERT(NumFreeRuns() == 1 && LargestFreeRun() == numBits);
+
+    ASSERT(!Allocate(numBits + 1, frames));	// too many, nothing taken
+    ASSERT(NumFree() == numBits);
+
+    // a frame handed out zeroed and written, then taken over without
+    // being freed, as paging does, must be zeroed again
+    (void) ZeroFreeFrames();
+    first = Allocate();
+    memory = &(kernel->machine->mainMemory[first * PageSize]);
+    ZeroFill(first);
+    memory[0] = 1;
+    ZeroFill(first);
+    ASSERT(memory[0] == 0);
+
+    // ... even if it was filled some other way, such as from a file
+    Free(first);
+    (void) ZeroFreeFrames();
+    first = Allocate();
+    memory = &(kernel->machine->mainMemory[first * PageSize]);
+    memory[0] = 1;
+    SetOwner(first, NULL, 0);
+    ZeroFill(first);
+    ASSERT(memory[0] == 0);
+    Free(first);
+}
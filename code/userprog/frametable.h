@@ -0,0 +1,113 @@
+// frametable.h
+//	Data structures to keep track of which physical page frames
+//	of the simulated machine are in use.
+//
+//	The frame table is a bitmap with one bit per physical frame.
+//	Free frames are found by scanning the bitmap a word at a time,
+//	skipping words whose frames are all in use, so an allocation
+//	touches at most NumPhysPages / BitsInWord words and never
+//	allocates any memory on the heap.
+//
+//	Frames can be allocated one at a time, in batches (a process
+//	asks for all of its pages at once), or as an aligned run of
+//	physically contiguous frames, for use as a large page.
+//
+//	The table also remembers which free frames are known to be all
+//	zeroes.  Frames are zeroed in the background, when the machine
+//	is idle, so that a process that needs clean memory usually
+//	doesn't have to wait for it to be cleared.
+//
+//	For demand paging, the table also records which virtual page
+//	of which address space each pageable frame holds (a "core map"),
+//	so that the page replacement algorithm can find the page table
+//	entry for a frame it wants to take away.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef FRAMETABLE_H
+#define FRAMETABLE_H
+
+#include "copyright.h"
+#include "bitmap.h"
+
+class AddrSpace;
+
+// The following class defines the physical frame allocator.  It
+// inherits the representation of a bitmap (see bitmap.h); a set bit
+// means the frame is in use.  Callers should only go through
+// Allocate/Free, so that the occupancy counters stay accurate.
+
+class FrameTable : public Bitmap {
+  public:
+    FrameTable(int numFrames);		// Initialize, all frames free
+    ~FrameTable();			// De-allocate frame table
+
+    int Allocate();			// Allocate one frame, return its
+					// number, or -1 if memory is full
+    bool Allocate(int count, int *frames);
+					// Allocate "count" frames, storing
+					// their numbers in "frames".  All or
+					// nothing: return FALSE (allocating
+					// nothing) if not enough are free
+    int AllocateContiguous(int count, int align);
+					// Allocate "count" physically
+					// contiguous frames, the first one
+					// a multiple of "align"; return the
+					// first frame, or -1 if no such run
+
+    void Free(int frame);		// Return one frame
+    void Free(int count, int *frames);	// Return a batch of frames
+    void FreeContiguous(int first, int count);
+					// Return a contiguous run of frames
+
+    void SetOwner(int frame, AddrSpace *space, int vpn);
+					// Record that page "vpn" of "space"
+					// lives in "frame", so it can be
+					// paged out (NULL: it can't be)
+    AddrSpace *Owner(int frame) const { return owner[frame]; }
+    int OwnerPage(int frame) const { return ownerPage[frame]; }
+
+    void ZeroFill(int frame);		// Make sure a newly allocated frame
+					// is all zeroes
+    int ZeroFreeFrames();		// Zero the free frames that aren't
+					// yet; return how many
+
+    int NumFree() const { return numFree; }
+    int NumUsed() const { return numBits - numFree; }
+    int NumFreeRuns() const;		// # of maximal runs of free frames
+    int LargestFreeRun() const;		// length of the longest free run
+
+    void PrintStats() const;		// Print occupancy and fragmentation
+    void SelfTest();			// Test whether this module is working
+
+  private:
+    int numFree;			// # of frames not in use
+    int nextWord;			// every word before this one is
+					// full, so scans can start here
+    unsigned int *zeroed;		// bitmap: is the frame known to be
+					// all zeroes?  Only kept up to date
+					// while the frame is free, and until
+					// its first ZeroFill or owner
+    AddrSpace **owner;			// pageable frames: the address
+    int *ownerPage;			// space and virtual page using them
+
+    bool RunIsFree(int first, int count) const;
+					// are all of [first, first+count)
+					// free?
+    void MarkRun(int first, int count);	// set/clear a run of bits
+    void ClearRun(int first, int count);	// a word at a time
+
+    // counters, reported by PrintStats
+    int numAllocated;			// frames handed out, in total
+    int numReleased;			// frames given back, in total
+    int minFree;			// low-water mark of numFree
+    int contiguousRequests;		// calls to AllocateContiguous
+    int contiguousFailures;		// ... that found no run
+    int numZeroedIdle;			// frames zeroed in the background
+    int numZeroHits;			// ZeroFill found the frame zeroed
+    int numZeroMisses;			// ... or had to clear it
+};
+
+#endif // FRAMETABLE_H
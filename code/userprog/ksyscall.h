@@ -30,6 +30,11 @@ int SysWrite(char* buffer , int size , int id)
     return kernel->interrupt->Write(buffer, size, id);
 }
 
+int SysSeek(int position, int id)
+{
+    return kernel->interrupt->Seek(position, id);
+}
+
 int SysOpen(char *filename)
 {
     return kernel->interrupt->Open(filename);
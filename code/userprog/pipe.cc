@@ -0,0 +1,159 @@
+// pipe.cc
+//	Routines to pass data between user programs through a pipe.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "pipe.h"
+
+//----------------------------------------------------------------------
+// Pipe::Pipe
+// 	Initialize an empty pipe, with both ends open.
+//----------------------------------------------------------------------
+
+Pipe::Pipe()
+{
+    head = 0;
+    count = 0;
+    readers = 1;
+    writers = 1;
+    lock = new Lock("pipe");
+    notEmpty = new Condition("pipe not empty");
+    notFull = new Condition("pipe not full");
+}
+
+//----------------------------------------------------------------------
+// Pipe::~Pipe
+// 	De-allocate a pipe.  Nobody may be waiting on it: both ends are
+//	closed, or Nachos is halting.
+//----------------------------------------------------------------------
+
+Pipe::~Pipe()
+{
+    delete lock;
+    delete notEmpty;
+    delete notFull;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Read
+// 	Wait until the pipe has some data, then take up to "size" bytes
+//	of it.  Writers are woken only when this makes PipeBatch bytes
+//	of room, so a writer blocked on a full pipe is not woken (and
+//	blocked again) for every small read.
+//
+//	Returns the number of bytes read, 0 if the pipe is empty and the
+//	write end is closed, or if "size" is 0.
+//----------------------------------------------------------------------
+
+int
+Pipe::Read(char *into, int size)
+{
+    int n, first;
+
+    if (size <= 0) {			// nothing to wait for
+	return 0;
+    }
+    lock->Acquire();
+    while (count == 0 && writers > 0) {
+	notEmpty->Wait(lock);
+    }
+    n = min(size, count);
+    first = min(n, PipeSize - head);		// up to the end of the buffer
+    bcopy(buffer + head, into, first);
+    bcopy(buffer, into + first, n - first);	// and the rest, from the start
+    head = (head + n) % PipeSize;
+    if (PipeSize - count < PipeBatch && PipeSize - (count - n) >= PipeBatch) {
+	notFull->Broadcast(lock);
+    }
+    count -= n;
+    DEBUG(dbgSys, "Pipe read " << n << " bytes, " << count << " left");
+    lock->Release();
+    return n;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Write
+// 	Put "size" bytes into the pipe, as much at a time as fits.  When
+//	it is full, wait for room: for all of what is left, or PipeBatch
+//	bytes of it, which Read makes before it wakes us.  Readers are
+//	woken once for each batch put into an empty pipe.
+//
+//	Returns the number of bytes written, or -1 if the read end was
+//	closed before any were.
+//----------------------------------------------------------------------
+
+int
+Pipe::Write(char *from, int size)
+{
+    int done = 0;
+
+    lock->Acquire();
+    while (done < size && readers > 0) {
+	int room = PipeSize - count;
+	int n, tail, first;
+
+	if (room < min(size - done, PipeBatch)) {
+	    notFull->Wait(lock);
+	    continue;
+	}
+	n = min(room, size - done);
+	tail = (head + count) % PipeSize;
+	first = min(n, PipeSize - tail);
+	bcopy(from + done, buffer + tail, first);
+	bcopy(from + done + first, buffer, n - first);
+	if (count == 0) {
+	    notEmpty->Broadcast(lock);
+	}
+	count += n;
+	done += n;
+	DEBUG(dbgSys, "Pipe write " << n << " bytes, " << count << " buffered");
+    }
+    lock->Release();
+    return (done == 0 && size > 0) ? -1 : done;
+}
+
+//----------------------------------------------------------------------
+// Pipe::Open
+// 	One more program holds the write end of the pipe, if "writeEnd",
+//	or else the read end.  The end must still be open.
+//----------------------------------------------------------------------
+
+void
+Pipe::Open(bool writeEnd)
+{
+    ASSERT(IsOpen(writeEnd));
+    if (writeEnd) {
+	writers++;
+    } else {
+	readers++;
+    }
+}
+
+//----------------------------------------------------------------------
+// Pipe::Close
+// 	A program lets go of the write end of the pipe, if "writeEnd",
+//	or else the read end.  When no program holds it any more, the
+//	end is closed: wake whoever waits for the other end; a reader
+//	now gets end of file, a writer fails.
+//----------------------------------------------------------------------
+
+void
+Pipe::Close(bool writeEnd)
+{
+    lock->Acquire();
+    if (writeEnd) {
+	ASSERT(writers > 0);
+	if (--writers == 0) {
+	    notEmpty->Broadcast(lock);
+	}
+    } else {
+	ASSERT(readers > 0);
+	if (--readers == 0) {
+	    notFull->Broadcast(lock);
+	}
+    }
+    lock->Release();
+}
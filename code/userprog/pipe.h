@@ -0,0 +1,67 @@
+// pipe.h
+//	Data structures for pipes between user programs.
+//
+//	A pipe is a bounded buffer in the kernel, with a read end and a
+//	write end.  Read and Write on its ends work as on files, except
+//	that they block: a reader waits until there is some data, a
+//	writer until all of its data fits.  Read returns 0 (end of file)
+//	once the buffer is empty and the write end is closed; Write fails
+//	once the read end is closed.
+//
+//	Waiting threads are woken in batches, not for every byte: readers
+//	only when an empty pipe gets data, writers only when the free
+//	space grows past half the buffer.
+//
+//	The ids of the two ends are the address of the pipe, and one
+//	more; being odd, a write end never collides with an open file id,
+//	which is the (aligned) address of an OpenFile.
+//
+//	Each program holds the ends it created, and those its parent
+//	held when it was started by Exec.  An end stays open until every
+//	program holding it has closed it, or exited.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PIPE_H
+#define PIPE_H
+
+#include "copyright.h"
+#include "synch.h"
+
+const int PipeSize = 512;		// bytes buffered in a pipe
+const int PipeBatch = PipeSize / 2;	// free space that wakes writers
+
+// The following class defines a pipe.
+
+class Pipe {
+  public:
+    Pipe();				// Initialize an empty pipe, with
+					// both ends open
+    ~Pipe();				// De-allocate the pipe
+
+    int ReadId() { return (int) this; }
+    int WriteId() { return (int) this + 1; }
+
+    int Read(char *into, int size);	// Wait for data, then take up to
+					// "size" bytes; 0 at end of file
+    int Write(char *from, int size);	// Put "size" bytes, waiting for
+					// room; -1 if nobody can read them
+    void Open(bool writeEnd);		// One more program holds an end
+    void Close(bool writeEnd);		// ... one less; the end is closed
+					// when none holds it
+    bool IsOpen(bool writeEnd) { return (writeEnd ? writers : readers) > 0; }
+    bool IsClosed() { return readers == 0 && writers == 0; }
+
+  private:
+    char buffer[PipeSize];		// circular buffer
+    int head;				// where the next byte is read
+    int count;				// # of bytes in the buffer
+    int readers, writers;		// # of programs holding each end
+    Lock *lock;				// protects all the above
+    Condition *notEmpty;		// signalled when data arrives
+    Condition *notFull;			// signalled when room is made
+};
+
+#endif // PIPE_H
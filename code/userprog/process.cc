@@ -0,0 +1,259 @@
+// process.cc
+//	Routines to start user programs, and to hand the exit status of
+//	a program to its parent.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "process.h"
+#include "addrspace.h"
+
+//----------------------------------------------------------------------
+// Process::Process, Process::~Process
+// 	Initialize or de-allocate a process table entry.  The entry keeps
+//	its own copy of "name": the Exec system call passes a buffer that
+//	goes away, and the name must last as long as the thread.
+//----------------------------------------------------------------------
+
+Process::Process(int processId, int parentId, char *programName)
+{
+    pid = processId;
+    parent = parentId;
+    name = new char[strlen(programName) + 1];
+    strcpy(name, programName);
+    exited = FALSE;
+    exitStatus = 0;
+    joining = FALSE;
+    done = new Condition("process done");
+}
+
+Process::~Process()
+{
+    delete [] name;
+    delete done;
+}
+
+//----------------------------------------------------------------------
+// ProcessStart
+// 	Body of the thread of a new process: load the program, and run
+//	it.  A program that can't be loaded exits with status -1.
+//----------------------------------------------------------------------
+
+static void
+ProcessStart(Thread *t)
+{
+    if (!t->space->Load(t->getName())) {
+	kernel->processTable->Exit(-1);
+    }
+    t->space->Execute(t->getName());
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::ProcessTable
+// 	Initialize an empty process table, with InitialProcesses pids.
+//----------------------------------------------------------------------
+
+ProcessTable::ProcessTable()
+{
+    tableSize = 0;
+    table = NULL;
+    freePids = NULL;
+    numFree = 0;
+    numProcesses = 0;
+    toBeReaped = NULL;
+    lock = new Lock("process table");
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::~ProcessTable
+// 	De-allocate the process table.  Processes still running at halt
+//	just go away.
+//----------------------------------------------------------------------
+
+ProcessTable::~ProcessTable()
+{
+    for (int pid = 0; pid < tableSize; pid++) {
+	delete table[pid];
+    }
+    delete toBeReaped;
+    delete [] table;
+    delete [] freePids;
+    delete lock;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::NewPid
+// 	Return an unused pid, the lowest one.  If there is none, double
+//	the size of the table first.  The lock must be held.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::NewPid()
+{
+    if (numFree == 0) {
+	int newSize = (tableSize == 0) ? InitialProcesses : tableSize * 2;
+	Process **newTable = new Process *[newSize];
+
+	for (int pid = 0; pid < newSize; pid++) {
+	    newTable[pid] = (pid < tableSize) ? table[pid] : NULL;
+	}
+	delete [] table;
+	delete [] freePids;
+	table = newTable;
+	freePids = new int[newSize];
+	for (int pid = newSize - 1; pid >= tableSize; pid--) {
+	    freePids[numFree++] = pid;		// lowest on top
+	}
+	DEBUG(dbgThread, "Process table grown to " << newSize << " entries");
+	tableSize = newSize;
+    }
+    return freePids[--numFree];
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::FreePid
+// 	Delete the entry of process "pid", and make "pid" available
+//	again.  The lock must be held.
+//
+//	To reuse the lowest pids first, a freed pid goes below any higher
+//	free pid on the stack; pids are freed about as often as they are
+//	allocated, so this is usually near the top.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::FreePid(int pid)
+{
+    int i;
+
+    delete table[pid];
+    table[pid] = NULL;
+    numProcesses--;
+    for (i = numFree; i > 0 && freePids[i - 1] < pid; i--) {
+	freePids[i] = freePids[i - 1];
+    }
+    freePids[i] = pid;
+    numFree++;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Exec
+// 	Start running the program in file "name", at "priority", as a
+//	child of process "parent" (-1 for none), and return its pid.
+//	The program is loaded by the new thread; if that fails, the
+//	process exits with status -1.  A child holds the pipe ends its
+//	parent holds.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Exec(char *name, int priority, int parent)
+{
+    Process *p;
+    Thread *t;
+
+    lock->Acquire();
+    p = new Process(NewPid(), parent, name);
+    table[p->pid] = p;
+    numProcesses++;
+    lock->Release();
+
+    t = new Thread(p->name, kernel->NewThreadID(), priority);
+    t->space = new AddrSpace();
+    t->space->SetPid(p->pid);
+    if (parent != -1)			// it gets our pipe ends too
+	kernel->InheritPipes(kernel->currentThread->space, t->space);
+    DEBUG(dbgThread, "Exec " << name << " as process " << p->pid
+		<< ", parent " << parent);
+    t->Fork((VoidFunctionPtr) ProcessStart, (void *) t);
+    return p->pid;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Join
+// 	Wait for child "pid" of the current process to exit, and return
+//	its exit status.  Its pid may then be reused.
+//
+//	Returns -1 if "pid" is not a child of the current process, or
+//	another thread is already joining it.
+//----------------------------------------------------------------------
+
+int
+ProcessTable::Join(int pid)
+{
+    int self = kernel->currentThread->space->Pid();
+    int status;
+    Process *p;
+
+    lock->Acquire();
+    p = (pid >= 0 && pid < tableSize) ? table[pid] : NULL;
+    if (p == NULL || p->parent != self || p->joining) {
+	lock->Release();
+	return -1;
+    }
+    p->joining = TRUE;
+    while (!p->exited) {
+	p->done->Wait(lock);
+    }
+    status = p->exitStatus;
+    FreePid(pid);
+    lock->Release();
+    return status;
+}
+
+//----------------------------------------------------------------------
+// ProcessTable::Exit
+// 	The current process is exiting with "status".  Close the pipe
+//	ends it holds, free its address space, and hand the status to its
+//	parent, if it has one; its children no longer do.  Then finish
+//	the thread: this does not return.
+//
+//	Interrupts are off from the time the entry may be freed until
+//	the thread is gone, so no other thread can see the entry freed
+//	while the thread still uses its name.
+//----------------------------------------------------------------------
+
+void
+ProcessTable::Exit(int status)
+{
+    AddrSpace *space = kernel->currentThread->space;
+    int self = space->Pid();
+    Process *p;
+
+    kernel->ClosePipes(space);		// wake whoever waits for them
+    delete space;			// still current, so the TLB is
+    kernel->currentThread->space = NULL;	// written back to it
+
+    lock->Acquire();
+    delete toBeReaped;			// its thread is gone by now
+    toBeReaped = NULL;
+    for (int pid = 0; pid < tableSize; pid++) {
+	Process *child = table[pid];
+
+	if (child == NULL || child->parent != self) {
+	    continue;
+	}
+	if (child->exited) {		// nobody will join it now
+	    FreePid(pid);
+	} else {
+	    child->parent = -1;
+	}
+    }
+
+    p = table[self];
+    p->exited = TRUE;
+    p->exitStatus = status;
+    DEBUG(dbgThread, "Process " << self << " exits with status " << status);
+    (void) kernel->interrupt->SetLevel(IntOff);
+    if (p->parent == -1) {		// forget it, but keep the name
+	table[self] = NULL;
+	toBeReaped = p;
+	FreePid(self);
+    } else {
+	p->done->Broadcast(lock);
+    }
+    lock->Release();
+    kernel->currentThread->Finish();
+    ASSERTNOTREACHED();
+}
@@ -0,0 +1,76 @@
+// process.h
+//	Data structures to keep track of running user programs.
+//
+//	A process is a user program with its own address space, started
+//	by a -e flag or the Exec system call.  It is named by a process
+//	id (pid), an index into the process table, so finding a process
+//	is a single array access.  The table grows (doubling) as more
+//	programs run at once, and the pids of processes that are gone
+//	are reused, lowest first.
+//
+//	A process started by Exec is the child of the process that called
+//	it; only the parent may Join it, to wait for it to exit and get
+//	its exit status.  The entry of a child that exited is kept until
+//	then.  A process with no parent (started by -e, or whose parent
+//	exited) is forgotten as soon as it exits.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include "copyright.h"
+#include "synch.h"
+
+const int InitialProcesses = 16;	// initial size of the table
+
+// One entry of the process table.
+
+class Process {
+  public:
+    Process(int pid, int parent, char *name);
+    ~Process();
+
+    int pid;
+    int parent;				// pid of the parent, -1 if none
+    char *name;				// executable file (our own copy)
+    bool exited;			// has called Exit
+    int exitStatus;			// what it passed to Exit
+    bool joining;			// the parent is in Join
+    Condition *done;			// signalled when it exits
+};
+
+// The following class defines the process table.
+
+class ProcessTable {
+  public:
+    ProcessTable();			// Initialize an empty table
+    ~ProcessTable();			// De-allocate the table
+
+    int Exec(char *name, int priority, int parent);
+					// Start running a program, return
+					// its pid; -1 on failure
+    int Join(int pid);			// Wait for child "pid" of the current
+					// process to exit, return its status
+    void Exit(int status);		// The current process is exiting
+
+    int NumProcesses() { return numProcesses; }
+
+  private:
+    Process **table;			// indexed by pid; NULL if unused
+    int tableSize;
+    int *freePids;			// stack of unused pids
+    int numFree;
+    int numProcesses;			// # of entries in use
+    Process *toBeReaped;		// process that exited with no
+					// parent; its name is still in use
+					// by its thread, until it's gone
+    Lock *lock;				// protects all the above
+
+    int NewPid();			// Allocate a pid, growing the table
+    void FreePid(int pid);		// Delete the entry for "pid"
+};
+
+#endif // PROCESS_H
@@ -0,0 +1,121 @@
+// sharedmem.cc
+//	Routines to create and reference count shared memory segments.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "sharedmem.h"
+#include "frametable.h"
+
+//----------------------------------------------------------------------
+// SharedMemory::SharedMemory
+// 	Initialize the segment table, with no segments.
+//----------------------------------------------------------------------
+
+SharedMemory::SharedMemory()
+{
+    for (int i = 0; i < MaxSegments; i++) {
+	numPages[i] = 0;
+	frames[i] = NULL;
+	numAttached[i] = 0;
+    }
+}
+
+//----------------------------------------------------------------------
+// SharedMemory::~SharedMemory
+// 	De-allocate the segment table.  The frames go away with the
+//	frame table.
+//----------------------------------------------------------------------
+
+SharedMemory::~SharedMemory()
+{
+    for (int i = 0; i < MaxSegments; i++) {
+	delete [] frames[i];
+    }
+}
+
+//----------------------------------------------------------------------
+// SharedMemory::Create
+// 	Return the id of the segment named "key".  If there is none,
+//	create it, with enough zeroed frames for "size" bytes.  Until
+//	some address space attaches it, nothing refers to a new segment;
+//	it is freed when the last address space detaches it.
+//
+//	Returns -1 if "size" is bad, or there is no room for the segment.
+//----------------------------------------------------------------------
+
+int
+SharedMemory::Create(int segmentKey, int size)
+{
+    int id = -1;
+    int count = divRoundUp(size, PageSize);
+
+    for (int i = 0; i < MaxSegments; i++) {
+	if (numPages[i] > 0 && key[i] == segmentKey) {
+	    return i;
+	}
+	if (numPages[i] == 0 && id == -1) {
+	    id = i;
+	}
+    }
+    if (id == -1 || size <= 0) {
+	return -1;
+    }
+    frames[id] = new int[count];
+    if (!kernel->frameTable->Allocate(count, frames[id])) {
+	delete [] frames[id];
+	frames[id] = NULL;
+	return -1;
+    }
+    for (int i = 0; i < count; i++) {
+	kernel->frameTable->ZeroFill(frames[id][i]);
+    }
+    key[id] = segmentKey;
+    numPages[id] = count;
+    numAttached[id] = 0;
+    DEBUG(dbgAddr, "Created shared segment " << id << ", key " << segmentKey
+		<< ", " << count << " pages");
+    return id;
+}
+
+//----------------------------------------------------------------------
+// SharedMemory::Attach
+// 	Note that one more address space uses segment "id", and return
+//	its frames, and in "*count" how many there are.  The caller maps
+//	them.  Returns NULL if there is no such segment.
+//----------------------------------------------------------------------
+
+int *
+SharedMemory::Attach(int id, int *count)
+{
+    if (id < 0 || id >= MaxSegments || numPages[id] == 0) {
+	return NULL;
+    }
+    numAttached[id]++;
+    *count = numPages[id];
+    return frames[id];
+}
+
+//----------------------------------------------------------------------
+// SharedMemory::Detach
+// 	Note that an address space no longer uses segment "id"; it has
+//	already unmapped its frames.  When nobody uses the segment any
+//	more, its frames are freed.
+//----------------------------------------------------------------------
+
+void
+SharedMemory::Detach(int id)
+{
+    ASSERT(numAttached[id] > 0);
+    if (--numAttached[id] > 0) {
+	return;
+    }
+    DEBUG(dbgAddr, "Freeing shared segment " << id);
+    kernel->frameTable->Free(numPages[id], frames[id]);
+    delete [] frames[id];
+    frames[id] = NULL;
+    numPages[id] = 0;
+}
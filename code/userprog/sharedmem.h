@@ -0,0 +1,48 @@
+// sharedmem.h
+//	Data structures for shared memory segments.
+//
+//	A segment is a set of physical frames that can be mapped into
+//	several address spaces at once (see AddrSpace::ShmAttach), so
+//	user programs can exchange data through memory instead of files.
+//	Segments are named by a key chosen by the programs, and live as
+//	long as some address space has them attached.
+//
+//	Segment frames are allocated and zeroed when the segment is
+//	created, and are never paged out.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SHAREDMEM_H
+#define SHAREDMEM_H
+
+#include "copyright.h"
+#include "utility.h"
+
+const int MaxSegments = 16;		// segments in the whole system
+
+// The following class keeps the shared memory segments of the system.
+
+class SharedMemory {
+  public:
+    SharedMemory();			// Initialize, no segments
+    ~SharedMemory();			// Free every segment
+
+    int Create(int key, int size);	// Return the segment named "key",
+					// creating it with "size" bytes if
+					// there is none; -1 on failure
+    int *Attach(int id, int *numPages);	// Count one more user of segment
+					// "id"; return its frames, NULL if
+					// there is no such segment
+    void Detach(int id);		// One user fewer; free the segment
+					// after the last
+
+  private:
+    int key[MaxSegments];
+    int numPages[MaxSegments];		// 0 if the segment is unused
+    int *frames[MaxSegments];		// frames of each segment
+    int numAttached[MaxSegments];	// # of address spaces using it
+};
+
+#endif // SHAREDMEM_H
@@ -0,0 +1,87 @@
+// swap.cc
+//	Routines to manage the swap space.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "debug.h"
+#include "machine.h"
+#include "swap.h"
+
+//----------------------------------------------------------------------
+// SwapSpace::SwapSpace
+// 	Initialize the swap space, using every sector of "disk" as a
+//	page-sized slot.
+//----------------------------------------------------------------------
+
+SwapSpace::SwapSpace(SynchDisk *swapDisk)
+{
+    ASSERT(PageSize == SectorSize);	// one sector per slot
+    disk = swapDisk;
+    slots = new FrameTable(NumSectors);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::~SwapSpace
+// 	De-allocate the swap space.
+//----------------------------------------------------------------------
+
+SwapSpace::~SwapSpace()
+{
+    delete slots;
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::Allocate, SwapSpace::Free
+// 	Allocate or release a run of "count" consecutive slots.
+//	Allocate returns the first slot, or -1 if there is no free run
+//	that long.
+//----------------------------------------------------------------------
+
+int
+SwapSpace::Allocate(int count)
+{
+    int first = slots->AllocateContiguous(count, 1);
+
+    DEBUG(dbgAddr, "Swap slots " << first << " .. " << first + count - 1);
+    return first;
+}
+
+void
+SwapSpace::Free(int first, int count)
+{
+    slots->FreeContiguous(first, count);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::ReadPages, SwapSpace::WritePages
+// 	Read or write "count" consecutive slots, starting at "first",
+//	with a single disk request.  "into"/"from" holds "count" pages.
+//----------------------------------------------------------------------
+
+void
+SwapSpace::ReadPages(int first, int count, char *into)
+{
+    disk->ReadSectors(first, count, into);
+}
+
+void
+SwapSpace::WritePages(int first, int count, char *from)
+{
+    disk->WriteSectors(first, count, from);
+}
+
+//----------------------------------------------------------------------
+// SwapSpace::WriteBehind
+// 	Start writing "count" pages from "from" to slots starting at
+//	"first", without waiting.  Returns FALSE if the disk is busy.
+//	Only to be called with interrupts off, from the idle loop.
+//----------------------------------------------------------------------
+
+bool
+SwapSpace::WriteBehind(int first, int count, char *from)
+{
+    return disk->WriteBehind(first, count, from);
+}
@@ -0,0 +1,53 @@
+// swap.h
+//	Data structures for the backing store of demand-paged address
+//	spaces.
+//
+//	Swap space is an array of page-sized slots on the simulated disk.
+//	Each address space gets one contiguous run of slots, one per
+//	virtual page, when it is loaded; so neighbouring virtual pages
+//	are neighbouring sectors, and a run of them can be transferred
+//	with a single disk request.
+//
+//	The swap space uses the whole disk, so it can only be used with
+//	the stub file system, which keeps its files in UNIX instead.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SWAP_H
+#define SWAP_H
+
+#include "copyright.h"
+#include "synchdisk.h"
+#include "frametable.h"
+
+// The following class defines the swap space.  Slots are handed out
+// with the same allocator as physical frames (see frametable.h), which
+// knows how to find contiguous runs.
+
+class SwapSpace {
+  public:
+    SwapSpace(SynchDisk *disk);		// Initialize, all slots free
+    ~SwapSpace();			// De-allocate the swap space
+
+    int Allocate(int count);		// Allocate "count" contiguous slots,
+					// return the first, or -1 if there
+					// is no such run
+    void Free(int first, int count);	// Return a run of slots
+
+    void ReadPages(int first, int count, char *into);
+    void WritePages(int first, int count, char *from);
+					// Transfer slots [first, first+count)
+					// from/to a buffer, as one disk
+					// request
+    bool WriteBehind(int first, int count, char *from);
+					// Start writing slots, if the disk
+					// is idle; don't wait
+
+  private:
+    SynchDisk *disk;			// where the slots are
+    FrameTable *slots;			// which slots are in use
+};
+
+#endif // SWAP_H
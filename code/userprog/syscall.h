@@ -32,6 +32,22 @@
 #define SC_ExecV	13
 #define SC_ThreadExit   14
 #define SC_ThreadJoin   15
+#define SC_RegisterRing	20
+#define SC_SubmitAndWait 21
+#define SC_AsyncRead	22
+#define SC_AsyncWrite	23
+#define SC_WaitIO	24
+#define SC_PollIO	25
+#define SC_Mmap		26
+#define SC_Munmap	27
+#define SC_ReadV	28
+#define SC_WriteV	29
+#define SC_Sbrk		30
+#define SC_ShmCreate	31
+#define SC_ShmAttach	32
+#define SC_ShmDetach	33
+#define SC_Pipe		34
+#define SC_SetDeadline	35
 #define SC_Add		42
 #define SC_MSG		100
 
@@ -80,7 +96,10 @@ typedef int SpaceId;
 /* A unique identifier for a thread within a task */
 typedef int ThreadId;
 
-/* Run the specified executable, with no args */
+/* Run the specified executable, with no args, as a child of this
+ * program; return its id, or -1 on failure.  If the executable can't
+ * be loaded, the child exits at once with status -1.
+ */
 /* This can be implemented as a call to ExecV.
  */
 SpaceId Exec(char* exec_name);
@@ -92,7 +111,8 @@ SpaceId Exec(char* exec_name);
 SpaceId ExecV(int argc, char* argv[]);
 
 /* Only return once the user program "id" has finished.
- * Return the exit status.
+ * Return the exit status; -1 if "id" is not a child of this program.
+ * A child can be joined only once; then its id may be reused.
  */
 int Join(SpaceId id);
 
@@ -161,13 +181,15 @@ int Seek(int position, OpenFileId id);
  */
 
 /* Fork a thread to run a procedure ("func") in the *same* address space
- * as the current thread.
+ * as the current thread.  It gets a stack of its own, of ThreadStackPages
+ * pages; if "func" returns, the thread exits with what it returned.
  * Return a positive ThreadId on success, negative error code on failure
  */
 ThreadId ThreadFork(void (*func)());
 
 /* Yield the CPU to another runnable thread, whether in this address space
- * or not.
+ * or not.  A real-time thread (see SetDeadline) is done for this period:
+ * it gives up the rest of its budget, and waits for the next period.
  */
 void ThreadYield();
 
@@ -183,6 +205,150 @@ int ThreadJoin(ThreadId id);
 void ThreadExit(int ExitCode);
 
 
+/* Batched system calls: Read, Write, Open, Close and Seek requests
+ * can be queued in a ring in the program's own memory, and the kernel
+ * runs all of them on a single SubmitAndWait trap, instead of one trap
+ * per call.
+ *
+ * The program adds a request at sq[sqTail % RingSize] and increments
+ * sqTail; the kernel takes requests from sqHead.  For each request it
+ * runs, the kernel adds a completion at cq[cqTail % RingSize] and
+ * increments cqTail; the program takes completions from cqHead.  The
+ * indices only ever grow.  Requests are run in order, and only while
+ * there is room for their completions.
+ */
+
+#define RingSize	32	/* entries in each ring, a power of two */
+
+#define RingRead	0	/* Read(addr, size, id) */
+#define RingWrite	1	/* Write(addr, size, id) */
+#define RingOpen	2	/* Open(addr) */
+#define RingClose	3	/* Close(id) */
+#define RingSeek	4	/* Seek(size, id) */
+
+typedef struct {
+    int op;			/* RingRead, RingWrite, ... */
+    int id;			/* OpenFileId */
+    int addr;			/* buffer, or file name for RingOpen */
+    int size;			/* # of bytes, or position for RingSeek */
+    int userData;		/* passed back in the completion */
+} RingRequest;
+
+typedef struct {
+    int userData;		/* from the request */
+    int result;			/* what the system call returned */
+} RingCompletion;
+
+typedef struct {
+    int sqHead, sqTail;		/* requests queued */
+    int cqHead, cqTail;		/* completions not yet consumed */
+    RingRequest sq[RingSize];
+    RingCompletion cq[RingSize];
+} IoRing;
+
+/* Register "ring" (word aligned, indices zeroed) as this program's
+ * ring.  Return 1 on success, -1 if "ring" is not a valid address.
+ */
+int RegisterRing(IoRing *ring);
+
+/* Run the queued requests.  Every request has completed when this
+ * returns.  Return the number of requests run, -1 if no ring is
+ * registered or its indices are corrupt.
+ */
+int SubmitAndWait();
+
+/* Asynchronous I/O.  AsyncRead and AsyncWrite start reading or writing
+ * "size" bytes of "buffer" and return at once, with a request id (or
+ * -1 if too many requests are outstanding).  The requests of a program
+ * are done in the order they were started.  The data of AsyncWrite is
+ * copied when it starts; the buffer of AsyncRead is filled in by WaitIO.
+ * A request transfers at most 4096 bytes.
+ */
+int AsyncRead(char *buffer, int size, OpenFileId id);
+int AsyncWrite(char *buffer, int size, OpenFileId id);
+
+/* Wait for request "request" to complete, and return what Read or
+ * Write would have returned; -1 if there is no such request.  Every
+ * request must be collected with WaitIO.
+ */
+int WaitIO(int request);
+
+/* Return 1 if request "request" has completed (WaitIO will not block),
+ * 0 if not, -1 if there is no such request.
+ */
+int PollIO(int request);
+
+/* Map "length" bytes of the open file "id", from position "offset",
+ * into memory, and return their address; NULL on failure.  Pages are
+ * read from the file when first used, and the ones modified are written
+ * back when they are evicted, or when the mapping is removed with
+ * Munmap (or the program exits).  The file must stay open meanwhile.
+ */
+char *Mmap(OpenFileId id, int offset, int length);
+
+/* Remove the mapping at "addr", as returned by Mmap.
+ * Return 1 on success, -1 if there is no such mapping.
+ */
+int Munmap(char *addr);
+
+/* Vectored I/O: read or write the "count" (at most MaxIoVec) buffers
+ * described by "vec", in order, with one trap.  Return the total number
+ * of bytes read or written, -1 on failure.  A buffer read or written
+ * only in part (say, at the end of the file) is the last one.
+ */
+#define MaxIoVec	16
+
+typedef struct {
+    int addr;			/* buffer */
+    int size;			/* # of bytes in it */
+} IoVec;
+
+int ReadV(IoVec *vec, int count, OpenFileId id);
+int WriteV(IoVec *vec, int count, OpenFileId id);
+
+/* Move the end of the heap, which starts right after the program's
+ * data, by "delta" bytes, and return the old end; (char *) -1 if the
+ * heap can't grow (or shrink) that much.  New heap memory is zero.
+ * See malloc.h for a malloc built on this.
+ */
+char *Sbrk(int delta);
+
+/* Shared memory.  ShmCreate returns the id of the segment named "key",
+ * creating it with "size" zeroed bytes if there is none yet; -1 on
+ * failure.  ShmAttach maps segment "id" into this address space and
+ * returns its address, 0 on failure; every program attaching the same
+ * segment sees the same memory.  ShmDetach unmaps the segment at
+ * "addr", returning 1, or -1 if none is there.  A segment goes away
+ * when the last program detaches it (or exits).
+ *
+ * There is no atomic instruction: see ulock.h for locks that work on
+ * shared memory anyway.
+ */
+int ShmCreate(int key, int size);
+char *ShmAttach(int id);
+int ShmDetach(char *addr);
+
+/* Create a pipe, and store the ids of its read end in ends[0] and of
+ * its write end in ends[1]; return 0, or -1 on failure.  The ends are
+ * used with Read, Write and Close, like open files, but Read waits for
+ * data, and returns 0 once the pipe is empty and the write end closed;
+ * Write waits for room, and fails once the read end is closed.  A
+ * program started by Exec holds the ends this program holds; an end
+ * is closed once every program holding it has closed it, or exited.
+ */
+int Pipe(OpenFileId *ends);
+
+/* Make this thread real-time: it needs "budget" ticks of CPU time every
+ * "period" ticks, starting now, and runs ahead of every other thread,
+ * earliest deadline first, until it has had them.  A thread that has
+ * had its budget waits for its next period; ThreadYield gives up the
+ * rest of it.  Return 0, or -1 if the thread can't be admitted: the
+ * real-time threads would need too much of the CPU.  SetDeadline(0, 0)
+ * makes the thread an ordinary one again, and returns the number of
+ * deadlines it missed while real-time.
+ */
+int SetDeadline(int period, int budget);
+
 /* MP1 */
 void PrintInt(int number);
 OpenFileId Open(char *name);
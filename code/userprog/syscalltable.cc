@@ -0,0 +1,218 @@
+// syscalltable.cc
+//	Routines to dispatch system calls through a table of
+//	descriptors, and to report how they are used.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "syscalltable.h"
+#include "addrspace.h"
+
+//----------------------------------------------------------------------
+// SyscallTable::SyscallTable
+// 	Build a hash index from system call codes to the "numDesc"
+//	descriptors in "desc".  The codes are sparse (some are in the
+//	thousands), so they can't index an array directly; the hash
+//	has at least twice as many slots as descriptors, so a lookup
+//	takes one or two probes.
+//----------------------------------------------------------------------
+
+SyscallTable::SyscallTable(SyscallDesc *descs, int count)
+{
+    int size;
+
+    desc = descs;
+    numDesc = count;
+    for (size = 1; size < 2 * numDesc; size <<= 1)
+	;
+    indexMask = size - 1;
+    index = new int[size];
+    for (int h = 0; h < size; h++) {
+	index[h] = -1;
+    }
+    for (int i = 0; i < numDesc; i++) {
+	int h = desc[i].code & indexMask;
+
+	ASSERT(Find(desc[i].code) == -1);	// codes must be unique
+	ASSERT(desc[i].numArgs <= MaxSyscallArgs);
+	while (index[h] != -1) {
+	    h = (h + 1) & indexMask;
+	}
+	index[h] = i;
+    }
+
+    numCalls = new int[numDesc];
+    numBadArgs = new int[numDesc];
+    totalTicks = new int[numDesc];
+    latency = new int[numDesc][NumLatencyBuckets];
+    for (int i = 0; i < numDesc; i++) {
+	numCalls[i] = numBadArgs[i] = totalTicks[i] = 0;
+	for (int b = 0; b < NumLatencyBuckets; b++) {
+	    latency[i][b] = 0;
+	}
+    }
+}
+
+//----------------------------------------------------------------------
+// SyscallTable::~SyscallTable
+// 	De-allocate the index and the statistics.  The descriptors
+//	belong to the caller.
+//----------------------------------------------------------------------
+
+SyscallTable::~SyscallTable()
+{
+    delete [] index;
+    delete [] numCalls;
+    delete [] numBadArgs;
+    delete [] totalTicks;
+    delete [] latency;
+}
+
+//----------------------------------------------------------------------
+// SyscallTable::Find
+// 	Return the index of the descriptor for system call "code", or
+//	-1 if there is none.
+//----------------------------------------------------------------------
+
+int
+SyscallTable::Find(int code)
+{
+    for (int h = code & indexMask; index[h] != -1; h = (h + 1) & indexMask) {
+	if (desc[index[h]].code == code) {
+	    return index[h];
+	}
+    }
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// SyscallTable::Marshal
+// 	Read the arguments of system call "d" from the registers into
+//	"args", checking each as its kind says.  String arguments are
+//	copied into "strings", so the routine can't be confused by the
+//	user program changing them, or by a string crossing a page.
+//
+//	Returns FALSE if an argument is bad.
+//----------------------------------------------------------------------
+
+bool
+SyscallTable::Marshal(SyscallDesc *d, SyscallArgs *args,
+		char strings[][MaxStringArg])
+{
+    AddrSpace *space = kernel->currentThread->space;
+
+    for (int a = 0; a < d->numArgs; a++) {
+	args->value[a] = kernel->machine->ReadRegister(4 + a);
+	args->string[a] = NULL;
+    }
+    for (int a = 0; a < d->numArgs; a++) {
+	unsigned int vaddr = args->value[a];
+	int size;
+
+	switch (d->kind[a]) {
+	  case IntArg:
+	    break;
+	  case StringArg:
+	    if (space->CopyInString(vaddr, strings[a], MaxStringArg) < 0) {
+		DEBUG(dbgSys, d->name << ": bad string at " << vaddr);
+		return FALSE;
+	    }
+	    args->string[a] = strings[a];
+	    break;
+	  case BufferArg:
+	    ASSERT(a + 1 < d->numArgs);		// the size comes next
+	    size = args->value[a + 1];
+	    if (size < 0 || vaddr >= UserStackTop
+			|| (unsigned int) size > UserStackTop - vaddr) {
+		DEBUG(dbgSys, d->name << ": bad buffer at " << vaddr
+			<< ", size " << size);
+		return FALSE;
+	    }
+	    break;
+	}
+    }
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SyscallTable::Dispatch
+// 	Do system call "code" for the current thread: marshal its
+//	arguments, call its routine, store the result in r2, and
+//	advance the PC past the syscall instruction (or else the user
+//	program would make the same system call forever).  A system
+//	call with bad arguments isn't called; it returns the
+//	"errorResult" of its descriptor.
+//
+//	Returns FALSE if there is no system call "code".  System calls
+//	that end the thread (or Nachos) never return here.
+//----------------------------------------------------------------------
+
+bool
+SyscallTable::Dispatch(int code)
+{
+    Machine *machine = kernel->machine;
+    int i = Find(code);
+    SyscallDesc *d;
+    SyscallArgs args;
+    char strings[MaxSyscallArgs][MaxStringArg];
+    int result, pc;
+
+    if (i == -1) {
+	return FALSE;
+    }
+    d = &desc[i];
+    numCalls[i]++;
+    if (Marshal(d, &args, strings)) {
+	int start = kernel->stats->totalTicks;
+	int ticks, b;
+
+	result = (*d->handler)(&args);
+	ticks = kernel->stats->totalTicks - start;
+	totalTicks[i] += ticks;
+	for (b = 0; ticks > 0 && b < NumLatencyBuckets - 1; b++) {
+	    ticks >>= 1;
+	}
+	latency[i][b]++;
+    } else {
+	numBadArgs[i]++;
+	result = d->errorResult;
+    }
+
+    if (d->hasResult) {
+	machine->WriteRegister(2, result);
+    }
+    pc = machine->ReadRegister(PCReg);
+    machine->WriteRegister(PrevPCReg, pc);
+    machine->WriteRegister(PCReg, pc + 4);
+    machine->WriteRegister(NextPCReg, pc + 8);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// SyscallTable::PrintStats
+// 	Print, for each system call that was made, how many times it
+//	was called, how many calls had bad arguments, and how the
+//	ticks spent in it are distributed.
+//----------------------------------------------------------------------
+
+void
+SyscallTable::PrintStats()
+{
+    for (int i = 0; i < numDesc; i++) {
+	if (numCalls[i] == 0) {
+	    continue;
+	}
+	cout << "Syscall " << desc[i].name << ": calls " << numCalls[i];
+	cout << ", bad arguments " << numBadArgs[i];
+	cout << ", ticks " << totalTicks[i] << "\n";
+	cout << "Syscall " << desc[i].name << ": latency";
+	for (int b = 0; b < NumLatencyBuckets; b++) {
+	    cout << " " << latency[i][b];
+	}
+	cout << " (0, 1, 2-3, ... " << (1 << (NumLatencyBuckets - 2));
+	cout << "+ ticks)\n";
+    }
+}
@@ -0,0 +1,102 @@
+// syscalltable.h
+//	Data structures for table-driven system call dispatch.
+//
+//	Each system call is described by a SyscallDesc: its code, the
+//	kernel routine that implements it, and the kind of each of its
+//	arguments.  The dispatcher reads the argument registers once,
+//	checks and copies in pointer arguments as their kinds say, calls
+//	the routine, stores its result in r2 and advances the PC -- so
+//	the routines themselves only do the work of the system call.
+//
+//	The dispatcher also counts the calls to each system call, and
+//	keeps a histogram of how long (in simulated ticks) they took.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef SYSCALLTABLE_H
+#define SYSCALLTABLE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+const int MaxSyscallArgs = 4;		// arguments are passed in r4-r7
+const int MaxStringArg = 256;		// longest string argument, including
+					// the terminating null
+const int NumLatencyBuckets = 8;	// 0, 1, 2-3, 4-7, ... 64+ ticks
+
+// The kinds of system call argument.
+
+enum SyscallArgKind {
+    IntArg,				// passed as is
+    StringArg,				// user string, copied into a kernel
+					// buffer; fails if bad or too long
+    BufferArg				// user buffer, checked to lie in the
+					// address space; its size must be
+					// the next argument
+};
+
+// The arguments of a system call, as handed to its routine.  For a
+// StringArg, "string" is the kernel copy; "value" is always the raw
+// register.
+
+struct SyscallArgs {
+    int value[MaxSyscallArgs];
+    char *string[MaxSyscallArgs];
+};
+
+typedef int (*SyscallHandler)(SyscallArgs *args);
+
+// The description of one system call.
+
+struct SyscallDesc {
+    int code;				// SC_xxx, from syscall.h
+    const char *name;			// for statistics
+    SyscallHandler handler;		// routine that does the work
+    int numArgs;
+    SyscallArgKind kind[MaxSyscallArgs];
+    bool hasResult;			// store the result in r2?
+    int errorResult;			// result if the arguments are bad
+};
+
+// The table of system calls the kernel supports, in exception.cc.
+
+extern SyscallDesc syscallDesc[];
+extern int numSyscallDesc;
+
+// The following class dispatches system calls through a table of
+// descriptors, and keeps statistics about them.
+
+class SyscallTable {
+  public:
+    SyscallTable(SyscallDesc *desc, int numDesc);
+					// Index the descriptors by code
+    ~SyscallTable();
+
+    bool Dispatch(int code);		// Do system call "code" for the
+					// current thread; FALSE if there
+					// is no such system call
+    void PrintStats();			// Print per system call counters
+
+  private:
+    int Find(int code);			// index of "code" in "desc", or -1
+    bool Marshal(SyscallDesc *d, SyscallArgs *args,
+		char strings[][MaxStringArg]);
+					// Read and check the arguments
+
+    SyscallDesc *desc;			// the descriptors
+    int numDesc;
+    int *index;				// hash of codes to descriptors,
+					// open addressing, -1 if empty
+    int indexMask;			// size of "index" - 1
+
+    // statistics, per descriptor
+    int *numCalls;
+    int *numBadArgs;			// calls rejected by Marshal
+    int *totalTicks;			// ticks spent in the calls that
+					// returned
+    int (*latency)[NumLatencyBuckets];	// histogram of ticks per call
+};
+
+#endif // SYSCALLTABLE_H
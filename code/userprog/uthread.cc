@@ -0,0 +1,280 @@
+// uthread.cc
+//	Routines to fork, join and end the threads of a user program.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "main.h"
+#include "uthread.h"
+#include "process.h"
+
+//----------------------------------------------------------------------
+// UserThreadStart
+// 	Body of the kernel thread of a forked user thread.
+//----------------------------------------------------------------------
+
+static void
+UserThreadStart(UserThreads *threads)
+{
+    threads->Start();
+}
+
+//----------------------------------------------------------------------
+// UserThreads::UserThreads
+// 	Start keeping track of the threads of "space".  So far there is
+//	just one: the current thread, which is running the program.
+//----------------------------------------------------------------------
+
+UserThreads::UserThreads(AddrSpace *addrSpace)
+{
+    space = addrSpace;
+    for (int id = 0; id < MaxUserThreads; id++) {
+	thread[id].inUse = FALSE;
+    }
+    thread[0].inUse = TRUE;
+    thread[0].thread = kernel->currentThread;
+    thread[0].exited = FALSE;
+    thread[0].joining = FALSE;
+    numLive = 1;
+    exiting = FALSE;
+    lock = new Lock("user threads");
+    threadExited = new Condition("user thread exited");
+}
+
+//----------------------------------------------------------------------
+// UserThreads::~UserThreads
+// 	De-allocate, when the address space goes away.  Every thread has
+//	exited by then.
+//----------------------------------------------------------------------
+
+UserThreads::~UserThreads()
+{
+    ASSERT(numLive == 0);
+    delete lock;
+    delete threadExited;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Self
+// 	Return the id of the current thread.  The lock must be held.
+//----------------------------------------------------------------------
+
+int
+UserThreads::Self()
+{
+    for (int id = 0; id < MaxUserThreads; id++) {
+	if (thread[id].inUse && !thread[id].exited
+			&& thread[id].thread == kernel->currentThread) {
+	    return id;
+	}
+    }
+    ASSERTNOTREACHED();
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Fork
+// 	Start a thread running the user procedure at "func", on a stack
+//	of its own.  When "func" returns, it goes to "exitAddr", which
+//	calls ThreadExit.  The thread has the priority of its creator.
+//
+//	Returns the id of the new thread, or -1 if MaxUserThreads are
+//	already in use.
+//----------------------------------------------------------------------
+
+int
+UserThreads::Fork(int func, int exitAddr)
+{
+    Thread *creator = kernel->currentThread;
+    Thread *t;
+    int id;
+
+    lock->Acquire();
+    for (id = 1; id < MaxUserThreads && thread[id].inUse; id++)
+	;
+    if (id == MaxUserThreads || exiting) {
+	lock->Release();
+	return -1;
+    }
+    t = new Thread(creator->getName(), kernel->NewThreadID(),
+			creator->getPriority());
+    t->space = space;
+    thread[id].inUse = TRUE;
+    thread[id].thread = t;
+    thread[id].func = func;
+    thread[id].exitAddr = exitAddr;
+    thread[id].exited = FALSE;
+    thread[id].joining = FALSE;
+    numLive++;
+    lock->Release();
+
+    DEBUG(dbgThread, "Forking user thread " << id << " at " << func);
+    t->Fork((VoidFunctionPtr) UserThreadStart, (void *) this);
+    return id;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Start
+// 	Set up the registers of a forked thread, and jump to its user
+//	procedure.  If the thread that ran before this one was of the
+//	same address space, its translations are still in the machine.
+//----------------------------------------------------------------------
+
+void
+UserThreads::Start()
+{
+    Machine *machine = kernel->machine;
+    UserThread *t;
+    int id;
+
+    CheckExiting();
+    lock->Acquire();
+    id = Self();
+    t = &thread[id];
+    lock->Release();
+
+    kernel->scheduler->LoadUserState(kernel->currentThread);
+    for (int i = 0; i < NumTotalRegs; i++) {
+	machine->WriteRegister(i, 0);
+    }
+    machine->WriteRegister(PCReg, t->func);
+    machine->WriteRegister(NextPCReg, t->func + 4);
+    machine->WriteRegister(StackReg, space->ThreadStackTop(id));
+    machine->WriteRegister(RetAddrReg, t->exitAddr);
+    machine->Run();
+    ASSERTNOTREACHED();
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Join
+// 	Wait for thread "id" to exit, and return its exit status.  Its
+//	id (and stack) may then be reused.
+//
+//	Returns -1 if there is no thread "id", it is the current thread,
+//	another thread is already joining it, or the program is exiting.
+//----------------------------------------------------------------------
+
+int
+UserThreads::Join(int id)
+{
+    UserThread *t;
+    int status;
+
+    if (id < 0 || id >= MaxUserThreads) {
+	return -1;
+    }
+    lock->Acquire();
+    t = &thread[id];
+    if (!t->inUse || t->joining || id == Self()) {
+	lock->Release();
+	return -1;
+    }
+    t->joining = TRUE;
+    while (!t->exited && !exiting) {
+	threadExited->Wait(lock);
+    }
+    if (!t->exited) {			// we'll be finished on the way out
+	t->joining = FALSE;
+	lock->Release();
+	return -1;
+    }
+    status = t->exitStatus;
+    t->inUse = FALSE;
+    if (id != 0) {			// the first thread uses the
+	space->FreeThreadStack(id);	// program's own stack
+    }
+    lock->Release();
+    return status;
+}
+
+//----------------------------------------------------------------------
+// UserThreads::Finish
+// 	The current thread exits with "status".  If it is the last one
+//	(and the program isn't already exiting), so does the program.
+//	The lock must be held; this does not return.
+//
+//	Interrupts are off from the time the lock is released until the
+//	thread is gone: a thread exiting the program may delete the
+//	address space as soon as it runs, and this thread must not run
+//	user code again in the meantime.
+//----------------------------------------------------------------------
+
+void
+UserThreads::Finish(int status)
+{
+    UserThread *t = &thread[Self()];
+
+    t->exited = TRUE;
+    t->exitStatus = status;
+    numLive--;
+    DEBUG(dbgThread, "User thread " << (t - thread) << " exits with status "
+		<< status);
+    if (numLive == 0 && !exiting) {
+	lock->Release();
+	kernel->processTable->Exit(status);
+	ASSERTNOTREACHED();
+    }
+    threadExited->Broadcast(lock);
+    (void) kernel->interrupt->SetLevel(IntOff);
+    lock->Release();
+    kernel->currentThread->Finish();
+    ASSERTNOTREACHED();
+}
+
+void
+UserThreads::Exit(int status)
+{
+    lock->Acquire();
+    Finish(status);
+}
+
+//----------------------------------------------------------------------
+// UserThreads::ExitProcess
+// 	The program exits with "status": wait for every other thread to
+//	finish (see CheckExiting), then exit the program.  Does not
+//	return.
+//
+//	The program's pipe ends are closed first: a thread blocked
+//	reading a pipe only this program writes would never finish.
+//----------------------------------------------------------------------
+
+void
+UserThreads::ExitProcess(int status)
+{
+    UserThread *t;
+
+    lock->Acquire();
+    if (exiting) {			// someone else is at it
+	Finish(status);
+    }
+    t = &thread[Self()];
+    exiting = TRUE;
+    t->exited = TRUE;
+    t->exitStatus = status;
+    numLive--;
+    threadExited->Broadcast(lock);	// joiners give up
+    kernel->ClosePipes(space);
+    while (numLive > 0) {
+	threadExited->Wait(lock);
+    }
+    lock->Release();
+    kernel->processTable->Exit(status);
+}
+
+//----------------------------------------------------------------------
+// UserThreads::CheckExiting
+// 	Called before a thread returns to user mode.  If the program is
+//	exiting, the thread is finished instead.
+//----------------------------------------------------------------------
+
+void
+UserThreads::CheckExiting()
+{
+    if (!exiting) {
+	return;
+    }
+    lock->Acquire();
+    Finish(0);
+}
@@ -0,0 +1,75 @@
+// uthread.h
+//	Data structures for the threads of a user program.
+//
+//	ThreadFork starts a new thread in the address space of the
+//	program that calls it, running a procedure of the program on its
+//	own user stack (see AddrSpace::ThreadStackTop), with its own
+//	registers; the threads share everything else.  Each is a kernel
+//	thread with a user part, scheduled like any other.
+//
+//	A thread is named by its slot, from 0 (the thread the program
+//	started with) to MaxUserThreads - 1.  ThreadExit ends a thread,
+//	and ThreadJoin waits for a thread to end and returns its status;
+//	an ended thread keeps its slot (and stack) until it is joined.
+//	The program exits once its last thread does.
+//
+//	Exit ends the whole program: every other thread is finished the
+//	next time it would return to user mode, and the thread calling
+//	Exit waits until they all have.
+//
+// Copyright (c) 1992-1996 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef UTHREAD_H
+#define UTHREAD_H
+
+#include "copyright.h"
+#include "synch.h"
+#include "addrspace.h"
+
+// One thread of a user program.
+
+class UserThread {
+  public:
+    bool inUse;				// slot taken, until joined
+    Thread *thread;			// valid until it has exited
+    int func;				// user procedure it starts in
+    int exitAddr;			// where "func" returns to
+    bool exited;			// has called ThreadExit
+    int exitStatus;
+    bool joining;			// another thread is in ThreadJoin
+};
+
+// The following class keeps the threads of one address space.
+
+class UserThreads {
+  public:
+    UserThreads(AddrSpace *space);	// The current thread is the first
+    ~UserThreads();			// De-allocate; all have exited
+
+    int Fork(int func, int exitAddr);	// Start a thread at "func", return
+					// its id; -1 if there are too many
+    int Join(int id);			// Wait for thread "id" to exit,
+					// return its status; -1 if none
+    void Exit(int status);		// The current thread exits
+    void ExitProcess(int status);	// The program exits
+    void CheckExiting();		// Finish the current thread if the
+					// program is exiting
+
+    void Start();			// Begin running a forked thread;
+					// run by its kernel thread
+
+  private:
+    AddrSpace *space;
+    UserThread thread[MaxUserThreads];
+    int numLive;			// # of threads not yet exited
+    bool exiting;			// Exit was called
+    Lock *lock;				// protects all the above
+    Condition *threadExited;		// signalled when a thread exits
+
+    int Self();				// Slot of the current thread
+    void Finish(int status);		// Exit, with the lock held
+};
+
+#endif // UTHREAD_H